@@ -1,84 +1,483 @@
 #include "Animation.hpp"
-#include "Model.hpp"
+
+void AnimationPlayback::advance(const double aDelta) noexcept {
+	this->time += aDelta * this->rate;
+}
 
 Animation::Animation() noexcept  {}
+Animation::Animation(const std::shared_ptr<const Animation>& aShared, std::vector<int64_t>&& aNodeMap) noexcept
+: mName(aShared->mName), mStart(aShared->mStart), mEnd(aShared->mEnd), mpShared(aShared), mNodeMap(std::move(aNodeMap)) {}
 
-void Animation::setStateAtTime(Model& aModel, const float aTime) noexcept {
-	//only calc and update local matrices of nodes
-	//rest done in model class
+//clip node to pose node, -1 = not there
+static int64_t mapNode(std::span<const int64_t> aNodeMap, const int64_t aNode) noexcept {
+	if(aNodeMap.empty() || aNode < 0) return aNode;
+	return (uint64_t)aNode < aNodeMap.size() ? aNodeMap[aNode] : -1;
+}
+//pose node left alone, nodes past the end of a short mask are
+static bool isMasked(std::span<const uint8_t> aNodeMask, const int64_t aNode) noexcept {
+	if(aNodeMask.empty()) return false;
+	return (uint64_t)aNode >= aNodeMask.size() || !aNodeMask[aNode];
+}
 
-	std::vector<TRSData> data;
-	data.reserve(this->mSamplers.size());
-	for(uint64_t i = 0; i < this->mSamplers.size(); i++) {
-		aModel.mNodes[this->mSamplers[i].nodeIndex].localMatrix = glm::mat4(1.0);
-		data.push_back(this->getLocalSamplerTransform(i, aTime));
+void Animation::setStateAtTime(Pose& aPose, const float aTime, std::span<const uint8_t> aNodeMask) const noexcept {
+	//only calc and update local TRS of nodes
+	//rest (matrices, joints) done in ModelData
+	if(this->mpShared) this->mpShared->setMappedState(aPose, aTime, aNodeMask, this->mNodeMap);
+	else this->setMappedState(aPose, aTime, aNodeMask, {});
+}
+
+void Animation::setMappedState(Pose& aPose, const float aTime, std::span<const uint8_t> aNodeMask, std::span<const int64_t> aNodeMap) const noexcept {
+	if(this->mResampleRate > 0.0f) {
+		this->setResampledState(aPose, aTime, aNodeMask, aNodeMap);
+		return;
 	}
+	if(this->mSampleRate > 0.0f) this->setCompressedState(aPose, aTime, aNodeMask, aNodeMap);
 
-	//local matrix reset in Model class
-	for(uint64_t i = 0; i < data.size(); i++) {
-		auto& node = aModel.mNodes[this->mSamplers[i].nodeIndex];
+	//compressed clips keep the samplers that were smaller raw
+	for(uint64_t i = 0; i < this->mSamplers.size(); i++) {
+		int64_t node = mapNode(aNodeMap, this->mSamplers[i].nodeIndex);
+		if(node < 0) continue;
+		if(isMasked(aNodeMask, node)) continue;
 
-		switch(data[i].type) {
+		TRSData data = this->getLocalSamplerTransform(i, aTime);
+		switch(data.type) {
 			case(fastgltf::AnimationPath::Translation):
-				node.localMatrix *= glm::translate(glm::mat4(1.0f), data[i].t);
+				aPose.translation[node] = data.t;
 				break;
 			case(fastgltf::AnimationPath::Rotation):
-				node.localMatrix *= glm::mat4_cast(data[i].r);
+				aPose.rotation[node] = data.r;
 				break;
 			case(fastgltf::AnimationPath::Scale):
-				node.localMatrix *= glm::scale(glm::mat4(1.0f), data[i].s);
+				aPose.scale[node] = data.s;
 				break;
 			default:
-				std::cerr << "Applying weight animation is not supported! (" << (uint16_t)data[i].type << ")\n";
+				std::cerr << "Applying weight animation is not supported! (" << (uint16_t)data.type << ")\n";
 				break;
 		}
 	}
 }
 
+std::string_view Animation::getName() const noexcept {
+	return this->mName;
+}
+
+float Animation::getStart() const noexcept {
+	return this->mStart;
+}
+float Animation::getEnd() const noexcept {
+	return this->mEnd;
+}
+float Animation::getDuration() const noexcept {
+	return this->mEnd - this->mStart;
+}
+float Animation::getClipTime(const double aTime, const LoopMode aMode) const noexcept {
+	double duration = this->mEnd - this->mStart;
+	if(duration <= 0.0) return this->mStart;
+
+	double time;
+	switch(aMode) {
+		case(LoopMode::CLAMP):
+			time = std::clamp(aTime, 0.0, duration);
+			break;
+		case(LoopMode::PING_PONG):
+			time = std::fmod(aTime, 2.0*duration);
+			if(time < 0.0) time += 2.0*duration;
+			if(time > duration) time = 2.0*duration - time;
+			break;
+		default:
+			time = std::fmod(aTime, duration);
+			if(time < 0.0) time += duration;
+			break;
+	}
+	return this->mStart + (float)time;
+}
+
+//smallest-three: the largest component is implied (made positive), the other 3 fit in [-1/sqrt(2), 1/sqrt(2)]
+static const float QuaternionRange = 0.70710678f;
+
+static void quantizeVector(const glm::vec4& aValue, const glm::vec3& aMinimum, const glm::vec3& aExtent, uint16_t* aOutput) noexcept {
+	for(uint64_t i = 0; i < 3; i++) {
+		float normalized = aExtent[i] > 0.0f ? (aValue[i] - aMinimum[i]) / aExtent[i] : 0.0f;
+		aOutput[i] = (uint16_t)std::lround(std::clamp(normalized, 0.0f, 1.0f) * 65535.0f);
+	}
+}
+static glm::vec4 dequantizeVector(const uint16_t* aInput, const glm::vec3& aMinimum, const glm::vec3& aExtent) noexcept {
+	return glm::vec4(aMinimum + aExtent * (glm::vec3(aInput[0], aInput[1], aInput[2]) * (1.0f/65535.0f)), 1.0f);
+}
+//x, y, z, w as in SamplerData
+static void quantizeQuaternion(glm::vec4 aValue, uint16_t* aOutput) noexcept {
+	uint16_t largest = 0;
+	for(uint16_t i = 1; i < 4; i++) if(std::abs(aValue[i]) > std::abs(aValue[largest])) largest = i;
+	if(aValue[largest] < 0.0f) aValue = -aValue;
+	for(uint16_t i = 0, o = 0; i < 4; i++) {
+		if(i == largest) continue;
+		float normalized = std::clamp(aValue[i] / QuaternionRange * 0.5f + 0.5f, 0.0f, 1.0f);
+		aOutput[o++] = (uint16_t)std::lround(normalized * 32767.0f);
+	}
+	aOutput[0] |= (largest & 1) << 15;
+	aOutput[1] |= (largest >> 1) << 15;
+}
+//selects only, no branches - component i is small[i - (i > largest)] unless it is the largest
+static glm::vec4 dequantizeQuaternion(const uint16_t* aInput) noexcept {
+	uint16_t largest = (aInput[0] >> 15) | ((aInput[1] >> 15) << 1);
+	glm::vec3 small = (glm::vec3(aInput[0] & 0x7FFF, aInput[1] & 0x7FFF, aInput[2] & 0x7FFF) * (1.0f/32767.0f) * 2.0f - 1.0f) * QuaternionRange;
+	float implied = std::sqrt(std::max(1.0f - glm::dot(small, small), 0.0f));
+	glm::vec4 result;
+	for(uint16_t i = 0; i < 4; i++) result[i] = i == largest ? implied : small[std::min<uint16_t>(i - (i > largest), 2)];
+	return result;
+}
+//normalized lerp, shortest way
+static glm::vec4 mixQuaternion(const glm::vec4& aFirst, const glm::vec4& aSecond, const float aWeight) noexcept {
+	float sign = glm::dot(aFirst, aSecond) < 0.0f ? -1.0f : 1.0f;
+	return glm::normalize(glm::mix(aFirst, aSecond * sign, aWeight));
+}
+//model space error of a local value, translation moves the subtree directly
+//aReach is how far the node's rotation/scale moves things
+static float getChannelError(const fastgltf::AnimationPath aType, const glm::vec4& aValue, const glm::vec4& aReference, const float aReach) noexcept {
+	switch(aType) {
+		case(fastgltf::AnimationPath::Rotation): {
+			//angle from the chord, acos loses small angles in float
+			glm::vec4 reference = glm::dot(aValue, aReference) < 0.0f ? -aReference : aReference;
+			return 4.0f * std::asin(std::min(glm::length(aValue - reference) * 0.5f, 1.0f)) * aReach;
+		}
+		case(fastgltf::AnimationPath::Scale):
+			return glm::length(glm::vec3(aValue) - glm::vec3(aReference)) * aReach;
+		default:
+			return glm::length(glm::vec3(aValue) - glm::vec3(aReference));
+	}
+}
+
+void Animation::compress(const float aSampleRate, std::span<const float> aBudgets, std::span<const float> aReaches, const Pose& aRestPose) noexcept {
+	if(this->mSamplers.empty() || this->isCompressed() || this->isResampled() || this->isShared()) return;
+
+	//no rate = the authored one, so the original keys land on the grid
+	//the clip end may fall between frames, the last frame sits on it
+	auto isEnd = [&](const float aTime) { return aTime >= this->mEnd - 1e-4f; };
+	float sampleRate = aSampleRate;
+	if(sampleRate <= 0.0f) {
+		float interval = this->getDuration();
+		for(const SamplerData& s : this->mSamplers) {
+			for(uint64_t k = 1; k < s.time.size(); k++) if(!isEnd(s.time[k]) && s.time[k] - s.time[k-1] > 1e-4f) interval = std::min(interval, s.time[k] - s.time[k-1]);
+		}
+		sampleRate = interval > 0.0f ? std::min(1.0f / interval, 120.0f) : 60.0f;
+		//irregular keys (not on that grid) get a fine one instead
+		for(const SamplerData& s : this->mSamplers) {
+			for(float t : s.time) {
+				float frame = (t - this->mStart) * sampleRate;
+				if(!isEnd(t) && std::abs(frame - std::round(frame)) > 1e-2f) sampleRate = 60.0f;
+			}
+		}
+	}
+	float lastPosition = this->getDuration() * sampleRate;
+	uint64_t lastFrame = std::ceil(lastPosition - 1e-3f);
+	auto getPosition = [&](const uint64_t aFrame) { return std::min((float)aFrame, lastPosition); };
+
+	//every channel on the frame grid, the last frame is the clip end
+	struct Channel {
+		fastgltf::AnimationPath type;
+		uint32_t node;
+		uint64_t sampler;
+		glm::vec3 minimum, extent;
+		std::vector<glm::vec4> samples, decoded;
+		std::vector<uint16_t> quantized; //3 per frame
+	};
+	std::vector<Channel> channels;
+	std::vector<ConstantTrack> constants;
+	std::vector<uint64_t> rawSamplers;
+	for(uint64_t s = 0; s < this->mSamplers.size(); s++) {
+		const SamplerData& sampler = this->mSamplers[s];
+		if(sampler.nodeIndex < 0 || (uint64_t)sampler.nodeIndex >= aBudgets.size()) continue;
+		if(sampler.type != fastgltf::AnimationPath::Translation && sampler.type != fastgltf::AnimationPath::Rotation && sampler.type != fastgltf::AnimationPath::Scale) continue;
+		bool rotation = sampler.type == fastgltf::AnimationPath::Rotation;
+		uint64_t node = sampler.nodeIndex;
+		float budget = aBudgets[node];
+		float reach = aReaches[node];
+
+		Channel channel = { sampler.type, (uint32_t)node, s, glm::vec3(0.0f), glm::vec3(0.0f), std::vector<glm::vec4>(lastFrame+1), std::vector<glm::vec4>(lastFrame+1), std::vector<uint16_t>((lastFrame+1)*3) };
+		glm::vec3 minimum = glm::vec3(std::numeric_limits<float>::max()), maximum = glm::vec3(-std::numeric_limits<float>::max());
+		for(uint64_t f = 0; f <= lastFrame; f++) {
+			float time = std::min(this->mStart + getPosition(f) / sampleRate, this->mEnd);
+			TRSData data = this->getLocalSamplerTransform(s, time);
+			if(rotation) {
+				channel.samples[f] = glm::vec4(data.r.x, data.r.y, data.r.z, data.r.w);
+				continue;
+			}
+			channel.samples[f] = glm::vec4(sampler.type == fastgltf::AnimationPath::Scale ? data.s : data.t, 1.0f);
+			minimum = glm::min(minimum, glm::vec3(channel.samples[f]));
+			maximum = glm::max(maximum, glm::vec3(channel.samples[f]));
+		}
+		if(!rotation) {
+			channel.minimum = minimum;
+			channel.extent = maximum - minimum;
+		}
+
+		//constant channels - nothing if the rest pose already has the value, 1 key otherwise
+		glm::vec4 rest = rotation ? glm::vec4(aRestPose.rotation[node].x, aRestPose.rotation[node].y, aRestPose.rotation[node].z, aRestPose.rotation[node].w) :
+			glm::vec4(sampler.type == fastgltf::AnimationPath::Scale ? aRestPose.scale[node] : aRestPose.translation[node], 1.0f);
+		bool atRest = true, constant = true;
+		for(uint64_t f = 0; f <= lastFrame; f++) {
+			atRest = atRest && getChannelError(sampler.type, channel.samples[f], rest, reach) <= budget;
+			constant = constant && getChannelError(sampler.type, channel.samples[f], channel.samples[0], reach) <= budget;
+		}
+		if(atRest) continue;
+		if(constant) {
+			if(sampler.time.size() <= 1) rawSamplers.push_back(s);
+			else constants.push_back({ sampler.type, (int32_t)node, channel.samples[0] });
+			continue;
+		}
+
+		for(uint64_t f = 0; f <= lastFrame; f++) {
+			if(rotation) {
+				quantizeQuaternion(channel.samples[f], &channel.quantized[f*3]);
+				channel.decoded[f] = dequantizeQuaternion(&channel.quantized[f*3]);
+			}
+			else {
+				quantizeVector(channel.samples[f], channel.minimum, channel.extent, &channel.quantized[f*3]);
+				channel.decoded[f] = dequantizeVector(&channel.quantized[f*3], channel.minimum, channel.extent);
+			}
+		}
+		channels.push_back(std::move(channel));
+	}
+
+	//greedy key reduction over every channel at once, per segment: a row is kept where the lerp between the
+	//(quantized) rows around it leaves the budget for any channel - O(segment length^2) per segment
+	std::vector<CompressedSegment> segments;
+	std::vector<uint64_t> rows; //frames of the clip
+	auto fits = [&](const Channel& aChannel, const uint64_t aAnchor, const uint64_t aEnd) {
+		for(uint64_t f = aAnchor+1; f < aEnd; f++) {
+			float weight = (getPosition(f) - getPosition(aAnchor)) / (getPosition(aEnd) - getPosition(aAnchor));
+			bool rotation = aChannel.type == fastgltf::AnimationPath::Rotation;
+			glm::vec4 value = rotation ? mixQuaternion(aChannel.decoded[aAnchor], aChannel.decoded[aEnd], weight) : glm::mix(aChannel.decoded[aAnchor], aChannel.decoded[aEnd], weight);
+			if(getChannelError(aChannel.type, value, aChannel.samples[f], aReaches[aChannel.node]) > aBudgets[aChannel.node]) return false;
+		}
+		return true;
+	};
+	auto findRows = [&]() {
+		segments.clear();
+		rows.clear();
+		for(uint64_t start = 0;; start += ANIMATION_SEGMENT_FRAMES) {
+			uint64_t end = std::min<uint64_t>(start + ANIMATION_SEGMENT_FRAMES, lastFrame);
+			segments.push_back({ (uint32_t)rows.size(), 0 });
+			rows.push_back(start);
+			uint64_t anchor = start;
+			for(uint64_t next = anchor+2; next <= end; next++) {
+				if(std::all_of(channels.begin(), channels.end(), [&](const Channel& aChannel) { return fits(aChannel, anchor, next); })) continue;
+				anchor = next-1;
+				rows.push_back(anchor);
+			}
+			if(end > start) rows.push_back(end);
+			segments.back().rowAmount = rows.size() - segments.back().rowOffset;
+			if(end >= lastFrame) break;
+		}
+	};
+	//a sampler with no more keys than there are rows is smaller raw - taking it out only removes rows
+	for(bool changed = !channels.empty(); changed;) {
+		findRows();
+		changed = false;
+		std::erase_if(channels, [&](const Channel& aChannel) {
+			if(this->mSamplers[aChannel.sampler].time.size() > rows.size()) return false;
+			rawSamplers.push_back(aChannel.sampler);
+			changed = true;
+			return true;
+		});
+	}
+	if(channels.empty()) {
+		segments.clear();
+		rows.clear();
+	}
+
+	//translation/scale first, so the decoder runs two plain loops
+	std::stable_partition(channels.begin(), channels.end(), [](const Channel& aChannel) { return aChannel.type != fastgltf::AnimationPath::Rotation; });
+	uint64_t rawBytes = this->getMemorySize(), rawKeys = this->getKeyAmount();
+	std::sort(rawSamplers.begin(), rawSamplers.end());
+	std::vector<SamplerData> samplers;
+	for(uint64_t s : rawSamplers) samplers.push_back(this->mSamplers[s]);
+	std::swap(this->mSamplers, samplers);
+
+	this->mRotationTrack = channels.size();
+	for(const Channel& c : channels) {
+		if(c.type == fastgltf::AnimationPath::Rotation) this->mRotationTrack = std::min<uint32_t>(this->mRotationTrack, this->mTracks.size());
+		this->mTracks.push_back({ c.type, (int32_t)c.node, c.minimum, c.extent });
+	}
+	for(uint64_t f : rows) {
+		for(const Channel& c : channels) this->mKeyValues.insert(this->mKeyValues.end(), c.quantized.begin() + f*3, c.quantized.begin() + f*3 + 3);
+	}
+	//stored relative to their segment, so clip length is not bounded by the index type
+	for(uint64_t i = 0; i < segments.size(); i++) {
+		for(uint64_t r = 0; r < segments[i].rowAmount; r++) this->mKeyFrames.push_back(rows[segments[i].rowOffset + r] - i*ANIMATION_SEGMENT_FRAMES);
+	}
+	this->mSegments = std::move(segments);
+	this->mConstants = std::move(constants);
+	this->mSampleRate = sampleRate;
+	this->mLastFrame = lastPosition;
+
+	//not worth it, back to the samplers
+	if(this->getMemorySize() >= rawBytes || this->getKeyAmount() >= rawKeys) {
+		std::swap(this->mSamplers, samplers);
+		this->mTracks.clear();
+		this->mConstants.clear();
+		this->mSegments.clear();
+		this->mKeyFrames.clear();
+		this->mKeyValues.clear();
+		this->mRotationTrack = 0;
+		this->mSampleRate = 0.0f;
+		this->mLastFrame = 0.0f;
+		return;
+	}
+	this->mTracks.shrink_to_fit();
+	this->mKeyFrames.shrink_to_fit();
+	this->mKeyValues.shrink_to_fit();
+}
+bool Animation::isCompressed() const noexcept {
+	return this->mSampleRate > 0.0f;
+}
+void Animation::resample(const float aSampleRate, const Pose& aRestPose) noexcept {
+	if(aSampleRate <= 0.0f || this->isResampled() || this->isShared()) return;
+
+	//channels from whichever form the clip is in now
+	std::vector<ResampledChannel> channels;
+	auto addChannel = [&](const fastgltf::AnimationPath aType, const int64_t aNode) {
+		if(aNode < 0 || (uint64_t)aNode >= aRestPose.translation.size()) return;
+		if(aType != fastgltf::AnimationPath::Translation && aType != fastgltf::AnimationPath::Rotation && aType != fastgltf::AnimationPath::Scale) return;
+		for(const ResampledChannel& c : channels) if(c.type == aType && c.node == aNode) return;
+		channels.push_back({ aType, (uint32_t)aNode, 0 });
+	};
+	for(const SamplerData& s : this->mSamplers) addChannel(s.type, s.nodeIndex);
+	for(const CompressedTrack& t : this->mTracks) addChannel(t.type, t.node);
+	for(const ConstantTrack& t : this->mConstants) addChannel(t.type, t.node);
+	if(channels.empty()) return;
+
+	uint32_t rowSize = 0;
+	for(ResampledChannel& c : channels) {
+		c.offset = rowSize;
+		rowSize += c.type == fastgltf::AnimationPath::Rotation ? 4 : 3;
+	}
+
+	//the last row sits on the clip end, which may fall between frames
+	float lastPosition = this->getDuration() * aSampleRate;
+	uint64_t lastRow = std::ceil(lastPosition - 1e-3f);
+	std::vector<float> rows((lastRow+1) * rowSize);
+	Pose pose = aRestPose;
+	for(uint64_t f = 0; f <= lastRow; f++) {
+		this->setStateAtTime(pose, std::min(this->mStart + std::min((float)f, lastPosition) / aSampleRate, this->mEnd));
+		float* row = rows.data() + f*rowSize;
+		for(const ResampledChannel& c : channels) {
+			float* value = row + c.offset;
+			switch(c.type) {
+				case(fastgltf::AnimationPath::Rotation): {
+					glm::quat r = pose.rotation[c.node];
+					//same hemisphere as the previous row, so the rows can be lerped
+					if(f > 0 && glm::dot(glm::vec4(r.x, r.y, r.z, r.w), glm::make_vec4(value - rowSize)) < 0.0f) r = -r;
+					value[0] = r.x; value[1] = r.y; value[2] = r.z; value[3] = r.w;
+					break;
+				}
+				case(fastgltf::AnimationPath::Scale):
+					std::copy_n(glm::value_ptr(pose.scale[c.node]), 3, value);
+					break;
+				default:
+					std::copy_n(glm::value_ptr(pose.translation[c.node]), 3, value);
+					break;
+			}
+		}
+	}
+
+	this->mChannels = std::move(channels);
+	this->mPoseRows = std::move(rows);
+	this->mRowSize = rowSize;
+	this->mResampleRate = aSampleRate;
+	this->mLastRow = lastPosition;
+
+	this->mSamplers.clear();
+	this->mSamplers.shrink_to_fit();
+	this->mTracks.clear();
+	this->mTracks.shrink_to_fit();
+	this->mConstants.clear();
+	this->mConstants.shrink_to_fit();
+	this->mSegments.clear();
+	this->mSegments.shrink_to_fit();
+	this->mKeyFrames.clear();
+	this->mKeyFrames.shrink_to_fit();
+	this->mKeyValues.clear();
+	this->mKeyValues.shrink_to_fit();
+	this->mRotationTrack = 0;
+	this->mSampleRate = 0.0f;
+}
+bool Animation::isResampled() const noexcept {
+	return this->mResampleRate > 0.0f;
+}
+bool Animation::isShared() const noexcept {
+	return this->mpShared != nullptr;
+}
+uint64_t Animation::getMemorySize() const noexcept {
+	uint64_t size = this->mTracks.size() * sizeof(CompressedTrack) + this->mKeyFrames.size() * sizeof(uint8_t) + this->mKeyValues.size() * sizeof(uint16_t);
+	size += this->mConstants.size() * sizeof(ConstantTrack) + this->mSegments.size() * sizeof(CompressedSegment);
+	size += this->mChannels.size() * sizeof(ResampledChannel) + this->mPoseRows.size() * sizeof(float);
+	size += this->mNodeMap.size() * sizeof(int64_t);
+	for(const SamplerData& s : this->mSamplers) size += s.time.size() * sizeof(float) + s.value.size() * sizeof(glm::vec4);
+	return size;
+}
+uint64_t Animation::getKeyAmount() const noexcept {
+	uint64_t amount = this->mKeyFrames.size()*this->mTracks.size() + this->mConstants.size();
+	amount += this->mRowSize > 0 ? this->mPoseRows.size() / this->mRowSize * this->mChannels.size() : 0;
+	for(const SamplerData& s : this->mSamplers) amount += s.time.size();
+	return amount;
+}
+
 Animation::~Animation() noexcept {}
 
-float Animation::lerp(float aLast, float aNext, float aCurrent) noexcept {
+float Animation::lerp(float aLast, float aNext, float aCurrent) const noexcept {
 	if(aCurrent <= aLast) return 0.0; //should not happen
 	if(aCurrent >= aNext) return 1.0;
 	return ((float)aCurrent - (float)aLast)/((float)aNext - (float)aLast); //should be in range 0-1
 }
-uint64_t Animation::getIndex(const SamplerData& aSampler, const float aTime) noexcept {
-	for(uint64_t i = 0; i < aSampler.time.size()-1; i++) {
+uint64_t Animation::getIndex(const SamplerData& aSampler, const float aTime) const noexcept {
+	//channels often end before the clip does - no search for those, lerp clamps the weight to 1
+	if(aSampler.time.size() >= 2 && aTime >= aSampler.time.back()) return aSampler.time.size()-2;
+	for(uint64_t i = 0; i+1 < aSampler.time.size(); i++) {
 		if(aTime < aSampler.time[i+1]) return i;
 	}
-	return aSampler.time.back();
+	//past the last key - last segment, lerp clamps the weight to 1
+	return aSampler.time.size() >= 2 ? aSampler.time.size()-2 : 0;
 }
-glm::vec3 Animation::interpolatePosition(const SamplerData& aSampler, const float aTime) noexcept {
+glm::vec3 Animation::interpolatePosition(const SamplerData& aSampler, const float aTime) const noexcept {
 	uint64_t start = getIndex(aSampler, aTime);
-	uint64_t end = start+1;
+	uint64_t end = std::min<uint64_t>(start+1, aSampler.time.size()-1); //single key samplers
 	float weight = lerp(aSampler.time[start], aSampler.time[end], aTime);
 	glm::vec3 position = glm::vec3(glm::mix(aSampler.value[start], aSampler.value[end], weight));
 	return position;
 }
-glm::quat Animation::interpolateRotation(const SamplerData& aSampler, const float aTime) noexcept {
+glm::quat Animation::interpolateRotation(const SamplerData& aSampler, const float aTime) const noexcept {
 	uint64_t start = getIndex(aSampler, aTime);
-	uint64_t end = start+1;
+	uint64_t end = std::min<uint64_t>(start+1, aSampler.time.size()-1); //single key samplers
 	float weight = lerp(aSampler.time[start], aSampler.time[end], aTime);
 	glm::quat qstart = glm::quat(aSampler.value[start].w, aSampler.value[start].x, aSampler.value[start].y, aSampler.value[start].z);
 	glm::quat qend = glm::quat(aSampler.value[end].w, aSampler.value[end].x, aSampler.value[end].y, aSampler.value[end].z);
 	glm::quat rotation = glm::normalize(glm::slerp(qstart, qend, weight));
 	return rotation;
 }
-glm::vec3 Animation::interpolateScale(const SamplerData& aSampler, const float aTime) noexcept {
+glm::vec3 Animation::interpolateScale(const SamplerData& aSampler, const float aTime) const noexcept {
 	uint64_t start = getIndex(aSampler, aTime);
-	uint64_t end = start+1;
+	uint64_t end = std::min<uint64_t>(start+1, aSampler.time.size()-1); //single key samplers
 	float weight = lerp(aSampler.time[start], aSampler.time[end], aTime);
 	glm::vec3 scale = glm::vec3(glm::mix(aSampler.value[start], aSampler.value[end], weight));
 	return scale;
 }
 
-TRSData Animation::getLocalSamplerTransform(const uint64_t aSamplerId, const float aTime) noexcept {
+void Animation::getTimeRange() noexcept {
+	if(this->mSamplers.empty()) return;
+	this->mStart = this->mSamplers[0].time.front();
+	this->mEnd = this->mSamplers[0].time.back();
+	for(const SamplerData& s : this->mSamplers) {
+		this->mStart = std::min(this->mStart, s.time.front());
+		this->mEnd = std::max(this->mEnd, s.time.back());
+	}
+}
+
+TRSData Animation::getLocalSamplerTransform(const uint64_t aSamplerId, const float aTime) const noexcept {
 	auto& sampler = this->mSamplers[aSamplerId];
 	TRSData result;
 	result.type = sampler.type;
 
-	//TRS enforced by sampler order
-
 	switch(sampler.type) {
 		case(fastgltf::AnimationPath::Translation):
 			result.t = interpolatePosition(sampler, aTime);
@@ -96,3 +495,92 @@ TRSData Animation::getLocalSamplerTransform(const uint64_t aSamplerId, const flo
 
 	return result;
 }
+
+void Animation::setCompressedState(Pose& aPose, const float aTime, std::span<const uint8_t> aNodeMask, std::span<const int64_t> aNodeMap) const noexcept {
+	float frame = std::clamp((aTime - this->mStart) * this->mSampleRate, 0.0f, this->mLastFrame);
+
+	for(const ConstantTrack& track : this->mConstants) {
+		int64_t node = mapNode(aNodeMap, track.node);
+		if(node < 0 || isMasked(aNodeMask, node)) continue;
+		switch(track.type) {
+			case(fastgltf::AnimationPath::Rotation):
+				aPose.rotation[node] = glm::quat(track.value.w, track.value.x, track.value.y, track.value.z);
+				break;
+			case(fastgltf::AnimationPath::Scale):
+				aPose.scale[node] = glm::vec3(track.value);
+				break;
+			default:
+				aPose.translation[node] = glm::vec3(track.value);
+				break;
+		}
+	}
+	if(this->mTracks.empty()) return;
+
+	//row pair around the frame, a segment holds a handful of rows - linear scan
+	uint64_t segmentId = std::min<uint64_t>(frame / ANIMATION_SEGMENT_FRAMES, this->mSegments.size()-1);
+	const CompressedSegment& segment = this->mSegments[segmentId];
+	const uint8_t* frames = this->mKeyFrames.data() + segment.rowOffset;
+	float local = frame - segmentId*ANIMATION_SEGMENT_FRAMES;
+	uint64_t first = 0;
+	while(first + 2 < segment.rowAmount && frames[first+1] <= local) first++;
+	uint64_t second = std::min<uint64_t>(first+1, segment.rowAmount-1);
+	float next = std::min((float)frames[second], this->mLastFrame - segmentId*ANIMATION_SEGMENT_FRAMES); //the last frame is the clip end
+	float weight = next > frames[first] ? std::clamp((local - frames[first]) / (next - frames[first]), 0.0f, 1.0f) : 0.0f;
+
+	//both rows have the same layout, column t*3 of each is track t
+	uint64_t stride = this->mTracks.size()*3;
+	const uint16_t* a = this->mKeyValues.data() + (segment.rowOffset + first)*stride;
+	const uint16_t* b = this->mKeyValues.data() + (segment.rowOffset + second)*stride;
+	for(uint64_t t = 0; t < this->mRotationTrack; t++) {
+		const CompressedTrack& track = this->mTracks[t];
+		int64_t node = mapNode(aNodeMap, track.node);
+		if(node < 0 || isMasked(aNodeMask, node)) continue;
+		//lerp of the quantized values, then one scale and offset
+		const uint16_t* from = a + t*3;
+		const uint16_t* to = b + t*3;
+		glm::vec3 quantized = glm::mix(glm::vec3(from[0], from[1], from[2]), glm::vec3(to[0], to[1], to[2]), weight);
+		glm::vec3 value = track.minimum + track.extent * (quantized * (1.0f/65535.0f));
+		if(track.type == fastgltf::AnimationPath::Scale) aPose.scale[node] = value;
+		else aPose.translation[node] = value;
+	}
+	for(uint64_t t = this->mRotationTrack; t < this->mTracks.size(); t++) {
+		int64_t node = mapNode(aNodeMap, this->mTracks[t].node);
+		if(node < 0 || isMasked(aNodeMask, node)) continue;
+		glm::vec4 r = mixQuaternion(dequantizeQuaternion(a + t*3), dequantizeQuaternion(b + t*3), weight);
+		aPose.rotation[node] = glm::quat(r.w, r.x, r.y, r.z);
+	}
+}
+
+void Animation::setResampledState(Pose& aPose, const float aTime, std::span<const uint8_t> aNodeMask, std::span<const int64_t> aNodeMap) const noexcept {
+	float frame = std::clamp((aTime - this->mStart) * this->mResampleRate, 0.0f, this->mLastRow);
+	uint64_t rowAmount = this->mPoseRows.size() / this->mRowSize;
+	uint64_t first = std::min<uint64_t>(frame, rowAmount > 1 ? rowAmount-2 : 0);
+	uint64_t second = std::min<uint64_t>(first+1, rowAmount-1);
+	float next = std::min((float)second, this->mLastRow);
+	float weight = next > first ? std::clamp((frame - first) / (next - first), 0.0f, 1.0f) : 0.0f;
+
+	//2 contiguous rows, channels in row order
+	const float* a = this->mPoseRows.data() + first*this->mRowSize;
+	const float* b = this->mPoseRows.data() + second*this->mRowSize;
+	for(const ResampledChannel& c : this->mChannels) {
+		int64_t node = mapNode(aNodeMap, c.node);
+		if(node < 0) continue;
+		if(isMasked(aNodeMask, node)) continue;
+		const float* from = a + c.offset;
+		const float* to = b + c.offset;
+
+		switch(c.type) {
+			case(fastgltf::AnimationPath::Rotation): {
+				glm::vec4 r = glm::normalize(glm::mix(glm::make_vec4(from), glm::make_vec4(to), weight));
+				aPose.rotation[node] = glm::quat(r.w, r.x, r.y, r.z);
+				break;
+			}
+			case(fastgltf::AnimationPath::Scale):
+				aPose.scale[node] = glm::mix(glm::make_vec3(from), glm::make_vec3(to), weight);
+				break;
+			default:
+				aPose.translation[node] = glm::mix(glm::make_vec3(from), glm::make_vec3(to), weight);
+				break;
+		}
+	}
+}
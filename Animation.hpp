@@ -1,6 +1,6 @@
 #ifndef GLTF_ANIMATION
 #define GLTF_ANIMATION
-#include "Mesh.hpp"
+#include "Core.hpp"
 
 struct TRSData {
 	glm::vec3 t, s;
@@ -11,37 +11,155 @@ struct TRSData {
 struct SamplerData {
 	fastgltf::AnimationPath type = (fastgltf::AnimationPath)0;
 	std::vector<glm::vec4> value;
-	std::vector<GLfloat> time;
+	std::vector<float> time;
 	int64_t nodeIndex;
 
 	SamplerData() noexcept : nodeIndex(-1) {}
-	SamplerData(const fastgltf::AnimationPath aType, std::vector<glm::vec4>& aValue, std::vector<GLfloat>& aTime, const int64_t aNodeIndex) noexcept
+	SamplerData(const fastgltf::AnimationPath aType, std::vector<glm::vec4>& aValue, std::vector<float>& aTime, const int64_t aNodeIndex) noexcept
 	:type(aType), value(aValue), time(aTime), nodeIndex(aNodeIndex) {}
 	~SamplerData() {}
 };
 
-class Model;
+//mutable per instance node state - local TRS (SoA, samplers overwrite only what they animate)
+//and the global matrices evaluated from it by ModelData
+struct Pose {
+	std::vector<glm::vec3> translation;
+	std::vector<glm::quat> rotation;
+	std::vector<glm::vec3> scale;
+	std::vector<glm::mat4> globalMatrix;
+};
+
+//what happens past the end of a clip
+enum class LoopMode : uint8_t {
+	LOOP = 0,
+	CLAMP, //hold the last key
+	PING_PONG //play backwards to the start, then forwards again
+};
+
+//playback of one clip by one instance - time accumulates in double, so long sessions do not drift
+struct AnimationPlayback {
+	uint64_t animation = 0;
+	double time = 0.0; //seconds since the clip started, before looping
+	float rate = 1.0f;
+	LoopMode mode = LoopMode::LOOP;
+
+	void advance(const double aDelta) noexcept;
+};
+
+//frames per segment of a compressed clip, bounds the key search and the key reduction
+#define ANIMATION_SEGMENT_FRAMES 16
+
+//animated channel of a compressed clip (Animation::compress), one column of every key row
+//keys sit on the clip's uniform frame grid, every key is 3 x 16 bit:
+//translation/scale normalized to the track's range, rotation smallest-three (3 x 15 bit + 2 bit index)
+struct CompressedTrack {
+	fastgltf::AnimationPath type;
+	int32_t node; //-1 = dropped, the column stays
+	glm::vec3 minimum, extent; //translation/scale range
+};
+
+//channel of a compressed clip that holds one value over the whole clip
+struct ConstantTrack {
+	fastgltf::AnimationPath type;
+	int32_t node;
+	glm::vec4 value; //x, y, z(, w) as in SamplerData
+};
+
+//ANIMATION_SEGMENT_FRAMES frames of a compressed clip, the frames its tracks need as key rows
+//the first and last frame are always rows, so a segment decodes on its own
+struct CompressedSegment {
+	uint32_t rowOffset, rowAmount; //into the key frame array
+};
+
+//one animated value of a resampled clip, offset in floats into every pose row (3 for translation/scale, 4 for rotation)
+struct ResampledChannel {
+	fastgltf::AnimationPath type;
+	uint32_t node;
+	uint32_t offset;
+};
+
+class ModelData;
 
 class Animation {
-	friend class Model;
+	friend class ModelData;
+	friend class AnimationLibrary;
 public:
 	Animation() noexcept;
+	//view of a shared clip (AnimationLibrary), aNodeMap takes its nodes to ours (-1 = we do not have it)
+	Animation(const std::shared_ptr<const Animation>& aShared, std::vector<int64_t>&& aNodeMap) noexcept;
+	Animation(const Animation& aOther) = default;
+	Animation(Animation&& aOther) noexcept = default;
+	Animation& operator=(const Animation& aOther) = default;
+	Animation& operator=(Animation&& aOther) noexcept = default;
+
+	//only overwrites the animated components of aPose, reset it first (ModelData::resetPose)
+	//nodes with a 0 in aNodeMask or past its end are left alone (animation LOD), empty mask = all nodes
+	//shared views map the clip's nodes to ours, the mask is by our nodes
+	void setStateAtTime(Pose& aPose, const float aTime, std::span<const uint8_t> aNodeMask = {}) const noexcept;
 
-	void setStateAtTime(Model& aModel, const float aTime) noexcept;
+	std::string_view getName() const noexcept;
+
+	//key time range over all channels, computed at load
+	float getStart() const noexcept;
+	float getEnd() const noexcept;
+	float getDuration() const noexcept;
+	//playback time (seconds since the clip started) to a key time for setStateAtTime
+	float getClipTime(const double aTime, const LoopMode aMode = LoopMode::LOOP) const noexcept;
+
+	//replaces the samplers with compressed tracks sampled at aSampleRate, 0 = the clip's key rate (see ModelData::compressAnimations)
+	//per node: aBudgets is the error allowed in model space, aReaches how far its rotation/scale moves things
+	//channels that stay at aRestPose within budget are dropped, samplers with no more keys than the rows they
+	//would take stay raw - the whole clip stays raw if the compressed form is not smaller in bytes and keys
+	void compress(const float aSampleRate, std::span<const float> aBudgets, std::span<const float> aReaches, const Pose& aRestPose) noexcept;
+	bool isCompressed() const noexcept;
+	//replaces samplers (or compressed tracks) with every channel sampled at aSampleRate into one row per frame
+	//sampling is then a direct row lookup and one lerp between 2 neighbouring rows, no key search
+	void resample(const float aSampleRate, const Pose& aRestPose) noexcept;
+	bool isResampled() const noexcept;
+	//a view of a clip owned by an AnimationLibrary - compress and resample do nothing
+	bool isShared() const noexcept;
+	//own key data in bytes, samplers, compressed tracks or pose rows (shared clips: just the node map)
+	uint64_t getMemorySize() const noexcept;
+	uint64_t getKeyAmount() const noexcept;
 
 	~Animation() noexcept;
 private:
 	std::string mName;
 
 	std::vector<SamplerData> mSamplers;
+	float mStart = 0.0f, mEnd = 0.0f;
+
+	std::vector<CompressedTrack> mTracks; //translation/scale first, then rotations
+	std::vector<ConstantTrack> mConstants;
+	std::vector<CompressedSegment> mSegments;
+	std::vector<uint8_t> mKeyFrames; //frame of every key row, from its segment's first frame
+	std::vector<uint16_t> mKeyValues; //key rows, 3 per track in mTracks order
+	uint32_t mRotationTrack = 0; //first rotation in mTracks
+	float mSampleRate = 0.0f;
+	float mLastFrame = 0.0f; //clip end in frames, the last key frame is rounded up from it
+
+	std::vector<ResampledChannel> mChannels;
+	std::vector<float> mPoseRows; //frame-major, mRowSize floats per frame
+	uint32_t mRowSize = 0;
+	float mResampleRate = 0.0f;
+	float mLastRow = 0.0f; //clip end in frames, like mLastFrame
+
+	std::shared_ptr<const Animation> mpShared;
+	std::vector<int64_t> mNodeMap; //shared clip node to our node
+
+	void getTimeRange() noexcept;
 
-	float lerp(float aLast, float aNext, float aCurrent) noexcept;
-	uint64_t getIndex(const SamplerData& aSampler, const float aTime) noexcept;
-	glm::vec3 interpolatePosition(const SamplerData& aSampler, const float aTime) noexcept;
-	glm::quat interpolateRotation(const SamplerData& aSampler, const float aTime) noexcept;
-	glm::vec3 interpolateScale(const SamplerData& aSampler, const float aTime) noexcept;
+	float lerp(float aLast, float aNext, float aCurrent) const noexcept;
+	uint64_t getIndex(const SamplerData& aSampler, const float aTime) const noexcept;
+	glm::vec3 interpolatePosition(const SamplerData& aSampler, const float aTime) const noexcept;
+	glm::quat interpolateRotation(const SamplerData& aSampler, const float aTime) const noexcept;
+	glm::vec3 interpolateScale(const SamplerData& aSampler, const float aTime) const noexcept;
 
-	TRSData getLocalSamplerTransform(const uint64_t aSamplerId, const float aTime) noexcept;
+	TRSData getLocalSamplerTransform(const uint64_t aSamplerId, const float aTime) const noexcept;
+	//aNodeMap: clip node to pose node, -1 = skipped (empty = same nodes)
+	void setMappedState(Pose& aPose, const float aTime, std::span<const uint8_t> aNodeMask, std::span<const int64_t> aNodeMap) const noexcept;
+	void setCompressedState(Pose& aPose, const float aTime, std::span<const uint8_t> aNodeMask, std::span<const int64_t> aNodeMap) const noexcept;
+	void setResampledState(Pose& aPose, const float aTime, std::span<const uint8_t> aNodeMask, std::span<const int64_t> aNodeMap) const noexcept;
 };
 
 #endif
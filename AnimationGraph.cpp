@@ -0,0 +1,259 @@
+#include "AnimationGraph.hpp"
+
+AnimationGraph::AnimationGraph() noexcept {}
+AnimationGraph::AnimationGraph(const ModelData& aData, const GraphDefinition& aDefinition) noexcept
+: mpData(&aData) {
+	this->mParameterNames = aDefinition.parameters;
+	this->mParameters.assign(aDefinition.parameters.size(), 0.0f);
+
+	auto findParameter = [&](const std::string& aName) -> int64_t {
+		if(aName.empty()) return -1;
+		int64_t id = this->getParameterId(aName);
+		if(id == -1) std::cerr << "Error: animation graph parameter " << aName << " does not exist!\n";
+		return id;
+	};
+	auto findState = [&](const std::string& aName) -> int64_t {
+		for(uint64_t i = 0; i < aDefinition.states.size(); i++) if(aDefinition.states[i].name == aName) return i;
+		std::cerr << "Error: animation graph state " << aName << " does not exist!\n";
+		return -1;
+	};
+
+	bool valid = !aDefinition.states.empty();
+	for(const GraphState& state : aDefinition.states) {
+		CompiledState compiled;
+		this->mStateNames.push_back(state.name);
+
+		compiled.pointOffset = this->mPoints.size();
+		compiled.pointAmount = state.points.size();
+		this->mPoints.insert(this->mPoints.end(), state.points.begin(), state.points.end());
+		std::sort(this->mPoints.begin() + compiled.pointOffset, this->mPoints.end(), [](const GraphBlendPoint& aFirst, const GraphBlendPoint& aSecond) {
+			return aFirst.position < aSecond.position;
+		});
+		for(const GraphBlendPoint& p : state.points) {
+			if(p.animation >= aData.getAnimationAmount()) {
+				std::cerr << "Error: animation graph state " << state.name << " uses animation " << p.animation << ", model has " << aData.getAnimationAmount() << "!\n";
+				valid = false;
+			}
+		}
+		if(state.points.empty()) {
+			std::cerr << "Error: animation graph state " << state.name << " has no clips!\n";
+			valid = false;
+		}
+
+		compiled.parameter = state.points.size() > 1 ? findParameter(state.parameter) : -1;
+		if(state.points.size() > 1 && compiled.parameter == -1) valid = false;
+		compiled.speed = state.speed;
+
+		compiled.eventOffset = this->mEvents.size();
+		compiled.eventAmount = state.events.size();
+		for(const GraphEvent& e : state.events) {
+			auto name = std::find(this->mEventNames.begin(), this->mEventNames.end(), e.name);
+			if(name == this->mEventNames.end()) name = this->mEventNames.insert(name, e.name);
+			this->mEvents.push_back({ (uint32_t)(name - this->mEventNames.begin()), e.time });
+		}
+		this->mStates.push_back(compiled);
+	}
+
+	//per state ranges - own transitions first, then the "*" ones
+	for(uint64_t s = 0; s < this->mStates.size(); s++) {
+		this->mStates[s].transitionOffset = this->mTransitions.size();
+		for(bool any : { false, true }) {
+			for(const GraphTransition& t : aDefinition.transitions) {
+				if(any != (t.from == "*")) continue;
+				if(!any && t.from != this->mStateNames[s]) continue;
+
+				int64_t target = findState(t.to);
+				int64_t parameter = findParameter(t.parameter);
+				if(target == -1 || (!t.parameter.empty() && parameter == -1)) {
+					valid = false;
+					continue;
+				}
+				if((uint64_t)target == s) continue; //"*" back into itself
+				this->mTransitions.push_back({ (int32_t)parameter, t.condition, t.threshold, t.exitTime, std::max(t.duration, 0.0f), (uint32_t)target });
+			}
+		}
+		this->mStates[s].transitionAmount = this->mTransitions.size() - this->mStates[s].transitionOffset;
+	}
+	for(const GraphTransition& t : aDefinition.transitions) {
+		if(t.from != "*" && findState(t.from) == -1) valid = false;
+	}
+
+	int64_t entry = aDefinition.entry.empty() ? 0 : findState(aDefinition.entry);
+	if(entry == -1) valid = false;
+	this->mValid = valid;
+	if(!valid) return;
+
+	this->mFades[0] = { (uint32_t)entry, 0.0, 0.0, 0.0f, 0.0f };
+	this->mFadeAmount = 1;
+
+	//worst case per frame: every fade a blend space (2 samples + blend) and a blend into the result
+	this->mProgram.reserve(GRAPH_MAX_FADES*4);
+	this->mFiredEvents.reserve(this->mEvents.size());
+	this->mSlots.resize(GRAPH_MAX_FADES*2);
+	for(Pose& p : this->mSlots) aData.resetPose(p);
+}
+
+bool AnimationGraph::isValid() const noexcept {
+	return this->mValid;
+}
+
+int64_t AnimationGraph::getParameterId(const std::string_view aName) const noexcept {
+	for(uint64_t i = 0; i < this->mParameterNames.size(); i++) if(this->mParameterNames[i] == aName) return i;
+	return -1;
+}
+void AnimationGraph::setParameter(const uint64_t aId, const float aValue) noexcept {
+	if(aId < this->mParameters.size()) this->mParameters[aId] = aValue;
+}
+float AnimationGraph::getParameter(const uint64_t aId) const noexcept {
+	return aId < this->mParameters.size() ? this->mParameters[aId] : 0.0f;
+}
+
+void AnimationGraph::update(const float aDelta) noexcept {
+	this->mFiredEvents.clear();
+	if(!this->mValid) return;
+
+	for(uint64_t i = 0; i < this->mFadeAmount; i++) {
+		Fade& fade = this->mFades[i];
+		const CompiledState& state = this->mStates[fade.state];
+		double previous = fade.phase;
+		float duration = this->getStateDuration(state);
+		fade.time += (double)aDelta * state.speed;
+		if(duration > 0.0f) fade.phase += (double)aDelta * state.speed / duration;
+		fade.elapsed += aDelta;
+
+		//events of the newest state only, fading out states are on their way out
+		if(i + 1 != this->mFadeAmount || state.eventAmount == 0) continue;
+		const Animation& clip = this->mpData->getAnimations()[this->mPoints[state.pointOffset].animation];
+		float from = this->getClipTime(this->mPoints[state.pointOffset].animation, previous) - clip.getStart();
+		float to = this->getClipTime(this->mPoints[state.pointOffset].animation, fade.phase) - clip.getStart();
+		bool wrapped = to < from || fade.phase - previous >= 1.0;
+		for(uint64_t e = state.eventOffset; e < state.eventOffset + state.eventAmount; e++) {
+			float t = this->mEvents[e].time;
+			if(wrapped ? (t > from || t <= to) : (t > from && t <= to)) this->mFiredEvents.push_back(this->mEvents[e].name);
+		}
+	}
+
+	//a finished fade covers every older one
+	for(uint64_t i = this->mFadeAmount; i-- > 1;) {
+		if(this->mFades[i].elapsed < this->mFades[i].duration) continue;
+		std::move(this->mFades.begin() + i, this->mFades.begin() + this->mFadeAmount, this->mFades.begin());
+		this->mFadeAmount -= i;
+		break;
+	}
+
+	const Fade& current = this->mFades[this->mFadeAmount-1];
+	const CompiledState& state = this->mStates[current.state];
+	for(uint64_t t = state.transitionOffset; t < state.transitionOffset + state.transitionAmount; t++) {
+		const CompiledTransition& transition = this->mTransitions[t];
+		if(current.time < transition.exitTime) continue;
+		if(transition.parameter != -1) {
+			float value = this->mParameters[transition.parameter];
+			bool passed = transition.condition == GraphCondition::GREATER ? value > transition.threshold : value < transition.threshold;
+			if(!passed) continue;
+		}
+
+		//out of slots, the oldest fade is cut
+		if(this->mFadeAmount == GRAPH_MAX_FADES) {
+			std::move(this->mFades.begin() + 1, this->mFades.end(), this->mFades.begin());
+			this->mFadeAmount--;
+		}
+		this->mFades[this->mFadeAmount++] = { transition.target, 0.0, 0.0, 0.0f, transition.duration };
+		break;
+	}
+}
+
+void AnimationGraph::evaluate(Pose& aPose, const uint64_t aJointLevel) noexcept {
+	if(!this->mValid) {
+		if(this->mpData) this->mpData->resetPose(aPose);
+		return;
+	}
+
+	//the program: every fade into its own slot pair, newer ones blended over slot 0 by their fade weight
+	//rebuilt every frame - the clips a blend space samples follow its parameter, so there is no fixed
+	//per state template to patch, and at most GRAPH_MAX_FADES*4 instructions go into reserved memory
+	this->mProgram.clear();
+	for(uint64_t i = 0; i < this->mFadeAmount; i++) {
+		this->emitState(this->mFades[i], i*2);
+		if(i == 0) continue;
+		const Fade& fade = this->mFades[i];
+		float weight = fade.duration > 0.0f ? glm::clamp(fade.elapsed / fade.duration, 0.0f, 1.0f) : 1.0f;
+		this->mProgram.push_back({ Op::BLEND, 0, (uint8_t)(i*2), 0, 0.0f, weight });
+	}
+
+	for(const Instruction& instruction : this->mProgram) {
+		switch(instruction.op) {
+			case(Op::SAMPLE):
+				this->mpData->setStateAtTime(this->mSlots[instruction.slot], instruction.animation, instruction.time, aJointLevel);
+				break;
+			case(Op::BLEND):
+				blendPoses(this->mSlots[instruction.slot], this->mSlots[instruction.source], instruction.weight);
+				break;
+		}
+	}
+
+	const Pose& result = this->mSlots[0];
+	aPose.translation = result.translation;
+	aPose.rotation = result.rotation;
+	aPose.scale = result.scale;
+	if(aPose.globalMatrix.size() != result.translation.size()) aPose.globalMatrix.resize(result.translation.size());
+}
+
+std::span<const uint64_t> AnimationGraph::getEvents() const noexcept {
+	return this->mFiredEvents;
+}
+std::string_view AnimationGraph::getEventName(const uint64_t aId) const noexcept {
+	return aId < this->mEventNames.size() ? std::string_view(this->mEventNames[aId]) : std::string_view();
+}
+uint64_t AnimationGraph::getState() const noexcept {
+	return this->mFadeAmount > 0 ? this->mFades[this->mFadeAmount-1].state : 0;
+}
+std::string_view AnimationGraph::getStateName(const uint64_t aId) const noexcept {
+	return aId < this->mStateNames.size() ? std::string_view(this->mStateNames[aId]) : std::string_view();
+}
+
+AnimationGraph::~AnimationGraph() noexcept {}
+
+float AnimationGraph::getClipTime(const uint64_t aAnimation, const double aPhase) const noexcept {
+	const Animation& clip = this->mpData->getAnimations()[aAnimation];
+	return clip.getStart() + (float)(aPhase - std::floor(aPhase)) * clip.getDuration();
+}
+void AnimationGraph::getBlendPoints(const CompiledState& aState, uint64_t& aFirst, uint64_t& aSecond, float& aWeight) const noexcept {
+	aFirst = aSecond = aState.pointOffset;
+	aWeight = 0.0f;
+	if(aState.parameter == -1 || aState.pointAmount == 1) return;
+
+	const GraphBlendPoint* points = this->mPoints.data() + aState.pointOffset;
+	float value = this->mParameters[aState.parameter];
+	uint64_t upper = 1;
+	while(upper + 1 < aState.pointAmount && points[upper].position < value) upper++;
+	float range = points[upper].position - points[upper-1].position;
+	aFirst = aState.pointOffset + upper-1;
+	aSecond = aState.pointOffset + upper;
+	aWeight = range > 0.0f ? glm::clamp((value - points[upper-1].position) / range, 0.0f, 1.0f) : 0.0f;
+}
+float AnimationGraph::getStateDuration(const CompiledState& aState) const noexcept {
+	uint64_t first, second;
+	float weight;
+	this->getBlendPoints(aState, first, second, weight);
+	const std::vector<Animation>& animations = this->mpData->getAnimations();
+	return glm::mix(animations[this->mPoints[first].animation].getDuration(), animations[this->mPoints[second].animation].getDuration(), weight);
+}
+
+//state into aSlot, blend spaces use aSlot+1 for the second clip
+void AnimationGraph::emitState(const Fade& aFade, const uint8_t aSlot) noexcept {
+	uint64_t first, second;
+	float weight;
+	this->getBlendPoints(this->mStates[aFade.state], first, second, weight);
+	const GraphBlendPoint& a = this->mPoints[first];
+	const GraphBlendPoint& b = this->mPoints[second];
+
+	//both clips at the same phase
+	if(weight <= 0.0f || weight >= 1.0f) {
+		const GraphBlendPoint& only = weight >= 1.0f ? b : a;
+		this->mProgram.push_back({ Op::SAMPLE, aSlot, 0, (uint32_t)only.animation, this->getClipTime(only.animation, aFade.phase), 0.0f });
+		return;
+	}
+	this->mProgram.push_back({ Op::SAMPLE, aSlot, 0, (uint32_t)a.animation, this->getClipTime(a.animation, aFade.phase), 0.0f });
+	this->mProgram.push_back({ Op::SAMPLE, (uint8_t)(aSlot+1), 0, (uint32_t)b.animation, this->getClipTime(b.animation, aFade.phase), 0.0f });
+	this->mProgram.push_back({ Op::BLEND, aSlot, (uint8_t)(aSlot+1), 0, 0.0f, weight });
+}
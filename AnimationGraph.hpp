@@ -0,0 +1,150 @@
+#ifndef GLTF_ANIMATIONGRAPH
+#define GLTF_ANIMATIONGRAPH
+#include "Blend.hpp"
+
+//data-driven animation state machine
+//GraphDefinition is the authored form (names), AnimationGraph compiles it once into indices and
+//per frame emits a flat list of sample/blend instructions run over preallocated pose slots
+
+//clip at a point of a 1D blend space
+//the clips of a blend space stay in phase: the state loops in the weighted length of the 2 clips it blends
+//and every clip is sampled at the same fraction of its own length
+struct GraphBlendPoint {
+	uint64_t animation;
+	float position = 0.0f;
+};
+
+//fired when the state's clip passes time (seconds from the clip start), every loop
+//blend spaces use their first clip (lowest position)
+struct GraphEvent {
+	std::string name;
+	float time;
+};
+
+struct GraphState {
+	std::string name;
+	std::vector<GraphBlendPoint> points; //one point = plain clip
+	std::string parameter; //blend space axis, empty for a plain clip
+	float speed = 1.0f;
+	std::vector<GraphEvent> events;
+};
+
+enum class GraphCondition : uint8_t {
+	GREATER = 0, //parameter > threshold
+	LESS //parameter < threshold
+};
+
+struct GraphTransition {
+	std::string from; //"*" = any state
+	std::string to;
+	std::string parameter; //empty = only exitTime
+	GraphCondition condition = GraphCondition::GREATER;
+	float threshold = 0.0f;
+	float exitTime = 0.0f; //seconds in the state before it may fire
+	float duration = 0.2f; //crossfade
+};
+
+struct GraphDefinition {
+	std::vector<std::string> parameters;
+	std::vector<GraphState> states;
+	std::vector<GraphTransition> transitions; //checked in order, state specific before "*"
+	std::string entry; //empty = first state
+};
+
+//crossfades that can overlap, older ones beyond this are cut
+#define GRAPH_MAX_FADES 4
+
+class AnimationGraph {
+public:
+	AnimationGraph() noexcept;
+	//prints and stays invalid (evaluates the rest pose) if names do not resolve
+	AnimationGraph(const ModelData& aData, const GraphDefinition& aDefinition) noexcept;
+
+	bool isValid() const noexcept;
+
+	//-1 if unknown, look up once and keep the id
+	int64_t getParameterId(const std::string_view aName) const noexcept;
+	void setParameter(const uint64_t aId, const float aValue) noexcept;
+	float getParameter(const uint64_t aId) const noexcept;
+
+	//advances clocks and fades by aDelta seconds, takes at most one transition, collects events
+	void update(const float aDelta) noexcept;
+	//runs this frame's program, local TRS of aPose
+	void evaluate(Pose& aPose, const uint64_t aJointLevel = 0) noexcept;
+
+	//events of the last update, as ids for getEventName
+	std::span<const uint64_t> getEvents() const noexcept;
+	std::string_view getEventName(const uint64_t aId) const noexcept;
+	uint64_t getState() const noexcept; //newest state
+	std::string_view getStateName(const uint64_t aId) const noexcept;
+
+	~AnimationGraph() noexcept;
+private:
+	struct CompiledState {
+		uint32_t pointOffset, pointAmount; //into mPoints, sorted by position
+		int32_t parameter; //-1 = plain clip
+		float speed;
+		uint32_t eventOffset, eventAmount; //into mEvents
+		uint32_t transitionOffset, transitionAmount; //into mTransitions, "*" ones appended
+	};
+	struct CompiledTransition {
+		int32_t parameter; //-1 = exit time only
+		GraphCondition condition;
+		float threshold;
+		float exitTime;
+		float duration;
+		uint32_t target;
+	};
+	struct CompiledEvent {
+		uint32_t name; //into mEventNames
+		float time;
+	};
+	struct Fade {
+		uint32_t state;
+		double time; //seconds in the state
+		double phase; //loops of the state's clips, fraction = position in every clip
+		float elapsed; //seconds since the fade started
+		float duration;
+	};
+
+	enum class Op : uint8_t {
+		SAMPLE = 0, //slot = animation at time
+		BLEND //slot = mix(slot, source, weight)
+	};
+	struct Instruction {
+		Op op;
+		uint8_t slot, source;
+		uint32_t animation;
+		float time;
+		float weight;
+	};
+
+	const ModelData* mpData = nullptr;
+	bool mValid = false;
+
+	std::vector<std::string> mParameterNames;
+	std::vector<float> mParameters;
+	std::vector<std::string> mStateNames;
+	std::vector<std::string> mEventNames;
+	std::vector<CompiledState> mStates;
+	std::vector<GraphBlendPoint> mPoints;
+	std::vector<CompiledEvent> mEvents;
+	std::vector<CompiledTransition> mTransitions;
+
+	//runtime, sized at compile time
+	std::array<Fade, GRAPH_MAX_FADES> mFades;
+	uint64_t mFadeAmount = 0; //oldest first
+	std::vector<uint64_t> mFiredEvents;
+	std::vector<Instruction> mProgram;
+	std::vector<Pose> mSlots; //2 per fade - blend spaces sample 2 clips
+
+	//phase to the key time of a clip (looped)
+	float getClipTime(const uint64_t aAnimation, const double aPhase) const noexcept;
+	//neighbours of the parameter on the state's axis (into mPoints, clamped to the ends), aWeight towards aSecond
+	void getBlendPoints(const CompiledState& aState, uint64_t& aFirst, uint64_t& aSecond, float& aWeight) const noexcept;
+	//seconds of one loop at the current parameter
+	float getStateDuration(const CompiledState& aState) const noexcept;
+	void emitState(const Fade& aFade, const uint8_t aSlot) noexcept;
+};
+
+#endif
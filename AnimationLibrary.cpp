@@ -0,0 +1,236 @@
+#include "AnimationLibrary.hpp"
+
+AnimationLibrary::AnimationLibrary() noexcept {}
+
+int64_t AnimationLibrary::load(const std::filesystem::path& aPath) noexcept {
+	std::error_code error;
+	std::filesystem::path path = std::filesystem::weakly_canonical(aPath, error);
+	if(error) path = aPath;
+	for(const auto& [loaded, skeleton] : this->mLoaded) if(loaded == path) return skeleton;
+
+	//only nodes and clips are needed, every image is skipped
+	ModelData data(aPath, [](const std::string&) { return true; });
+	if(data.getNodes().empty()) {
+		std::cerr << "Error: no skeleton in " << aPath << "!\n";
+		return -1;
+	}
+
+	std::vector<int64_t> nodeToJoint;
+	uint64_t skeleton = this->addSkeleton(data, nodeToJoint);
+	for(uint64_t i = 0; i < data.getAnimationAmount(); i++) this->addClip(skeleton, data, i, nodeToJoint);
+	this->mLoaded.push_back({ path, skeleton });
+	return skeleton;
+}
+
+int64_t AnimationLibrary::share(ModelData& aData) noexcept {
+	if(aData.getNodes().empty()) {
+		std::cerr << "Error: cannot share clips of a model without nodes!\n";
+		return -1;
+	}
+
+	std::vector<int64_t> nodeToJoint;
+	uint64_t skeleton = this->addSkeleton(aData, nodeToJoint);
+	//our own nodes, so the joint map inverted - names may repeat
+	std::vector<int64_t> nodeMap(this->mEntries[skeleton].skeleton.joints.size(), -1);
+	for(uint64_t id = 0; id < nodeToJoint.size(); id++) {
+		if(nodeToJoint[id] != -1) nodeMap[nodeToJoint[id]] = id;
+	}
+	for(uint64_t i = 0; i < aData.mAnimations.size(); i++) {
+		if(aData.mAnimations[i].isShared()) continue;
+		std::shared_ptr<const Animation> clip = this->addClip(skeleton, aData, i, nodeToJoint);
+		aData.mAnimations[i] = Animation(clip, std::vector<int64_t>(nodeMap));
+	}
+	return skeleton;
+}
+
+uint64_t AnimationLibrary::addClips(const uint64_t aSkeleton, ModelData& aData) const noexcept {
+	if(aSkeleton >= this->mEntries.size()) return 0;
+	std::vector<int64_t> nodeMap = this->getNodeMap(aSkeleton, aData);
+	if(std::all_of(nodeMap.begin(), nodeMap.end(), [](int64_t aNode) { return aNode == -1; })) {
+		std::cerr << "Error: model has no joint of skeleton " << aSkeleton << "!\n";
+		return 0;
+	}
+
+	//root motion comes with the clip, compressed and resampled ones have no keys left to derive it from
+	Pose rest;
+	aData.resetPose(rest);
+	aData.updateGlobalMatrices(rest);
+
+	uint64_t added = 0;
+	const Entry& entry = this->mEntries[aSkeleton];
+	for(uint64_t c = 0; c < entry.clips.size(); c++) {
+		const std::shared_ptr<const Animation>& clip = entry.clips[c];
+		bool present = std::any_of(aData.mAnimations.begin(), aData.mAnimations.end(), [&](const Animation& aAnimation) {
+			return aAnimation.isShared() ? aAnimation.mpShared == clip : aAnimation.getName() == clip->getName();
+		});
+		if(present) continue;
+		aData.mAnimations.emplace_back(clip, std::vector<int64_t>(nodeMap));
+		aData.mRootMotion.resize(aData.mAnimations.size());
+		aData.mRootMotion.back() = getRootMotion(entry.rootMotion[c], nodeMap, aData, rest);
+		added++;
+	}
+	return added;
+}
+
+uint64_t AnimationLibrary::getSkeletonAmount() const noexcept {
+	return this->mEntries.size();
+}
+const Skeleton& AnimationLibrary::getSkeleton(const uint64_t aSkeleton) const noexcept {
+	return this->mEntries[aSkeleton].skeleton;
+}
+const std::vector<std::shared_ptr<const Animation>>& AnimationLibrary::getClips(const uint64_t aSkeleton) const noexcept {
+	return this->mEntries[aSkeleton].clips;
+}
+uint64_t AnimationLibrary::getMemorySize() const noexcept {
+	uint64_t size = 0;
+	for(const Entry& e : this->mEntries) {
+		for(const std::shared_ptr<const Animation>& clip : e.clips) size += clip->getMemorySize();
+	}
+	return size;
+}
+
+AnimationLibrary::~AnimationLibrary() noexcept {}
+
+uint64_t AnimationLibrary::addSkeleton(const ModelData& aData, std::vector<int64_t>& aNodeToJoint) noexcept {
+	const std::vector<Node>& nodes = aData.getNodes();
+
+	//skin joints and whatever the clips move - files without a skin are all skeleton
+	std::vector<uint8_t> isJoint(nodes.size(), aData.getBones().empty() ? 1 : 0);
+	for(const Bone& b : aData.getBones()) {
+		for(uint64_t j : b.joints) if(j < isJoint.size()) isJoint[j] = 1;
+	}
+	auto mark = [&](const int64_t aNode) {
+		if(aNode >= 0 && (uint64_t)aNode < isJoint.size()) isJoint[aNode] = 1;
+	};
+	for(const Animation& a : aData.getAnimations()) {
+		if(a.isShared()) continue;
+		for(const SamplerData& s : a.mSamplers) mark(s.nodeIndex);
+		for(const CompressedTrack& t : a.mTracks) mark(t.node);
+		for(const ConstantTrack& t : a.mConstants) mark(t.node);
+		for(const ResampledChannel& c : a.mChannels) mark(c.node);
+	}
+
+	Skeleton skeleton;
+	aNodeToJoint.assign(nodes.size(), -1);
+	for(uint64_t id = 0; id < nodes.size(); id++) {
+		if(!isJoint[id]) continue;
+		aNodeToJoint[id] = skeleton.joints.size();
+		skeleton.joints.push_back({ nodes[id].name, -1 });
+	}
+	for(uint64_t id = 0; id < nodes.size(); id++) {
+		if(!isJoint[id]) continue;
+		int64_t parent = nodes[id].parent;
+		while(parent != -1 && !isJoint[parent]) parent = nodes[parent].parent;
+		SkeletonJoint& joint = skeleton.joints[aNodeToJoint[id]];
+		if(parent != -1) joint.parent = aNodeToJoint[parent];
+		//order independent, so the same rig exported twice finds itself
+		skeleton.key += std::hash<std::string>{}(joint.name + '/' + (parent != -1 ? nodes[parent].name : std::string()));
+	}
+
+	for(uint64_t e = 0; e < this->mEntries.size(); e++) {
+		const Skeleton& existing = this->mEntries[e].skeleton;
+		if(existing.key != skeleton.key || existing.joints.size() != skeleton.joints.size()) continue;
+		//same rig, our nodes to its joint order
+		for(uint64_t id = 0; id < nodes.size(); id++) {
+			if(aNodeToJoint[id] == -1) continue;
+			aNodeToJoint[id] = -1;
+			for(uint64_t j = 0; j < existing.joints.size(); j++) {
+				if(existing.joints[j].name == nodes[id].name) {
+					aNodeToJoint[id] = j;
+					break;
+				}
+			}
+		}
+		return e;
+	}
+
+	this->mEntries.push_back({ std::move(skeleton), {}, {} });
+	return this->mEntries.size()-1;
+}
+
+std::shared_ptr<const Animation> AnimationLibrary::addClip(const uint64_t aSkeleton, ModelData& aData, const uint64_t aId, std::span<const int64_t> aNodeToJoint) noexcept {
+	Animation& animation = aData.mAnimations[aId];
+	if(animation.isShared()) return animation.mpShared;
+
+	//our nodes to skeleton joints, whatever is not a joint is dropped
+	auto toJoint = [&](const int64_t aNode) -> int64_t {
+		return aNode >= 0 && (uint64_t)aNode < aNodeToJoint.size() ? aNodeToJoint[aNode] : -1;
+	};
+	for(SamplerData& s : animation.mSamplers) s.nodeIndex = toJoint(s.nodeIndex);
+	//compressed tracks are columns of the key rows, they stay
+	for(CompressedTrack& t : animation.mTracks) t.node = toJoint(t.node);
+	std::erase_if(animation.mConstants, [&](ConstantTrack& aTrack) {
+		aTrack.node = toJoint(aTrack.node);
+		return aTrack.node == -1;
+	});
+	std::erase_if(animation.mChannels, [&](ResampledChannel& aChannel) {
+		int64_t joint = toJoint(aChannel.node);
+		aChannel.node = std::max<int64_t>(joint, 0);
+		return joint == -1;
+	});
+
+	//files often repeat clip names ("Take 001"), so only the same keys are the same clip
+	Entry& entry = this->mEntries[aSkeleton];
+	for(const std::shared_ptr<const Animation>& clip : entry.clips) {
+		if(isSameClip(*clip, animation)) return clip;
+	}
+
+	//computed at load, while the clip still had its raw keys
+	RootMotion motion = aId < aData.mRootMotion.size() ? aData.mRootMotion[aId] : RootMotion();
+	motion.node = toJoint(motion.node);
+	entry.rootMotion.push_back(motion.node != -1 ? std::move(motion) : RootMotion());
+	entry.clips.push_back(std::make_shared<const Animation>(std::move(animation)));
+	std::cout << "Shared animation: " << entry.clips.back()->getName() << ", skeleton " << aSkeleton << '\n';
+	return entry.clips.back();
+}
+
+std::vector<int64_t> AnimationLibrary::getNodeMap(const uint64_t aSkeleton, const ModelData& aData) const noexcept {
+	const Skeleton& skeleton = this->mEntries[aSkeleton].skeleton;
+	std::unordered_map<std::string_view, uint64_t> byName;
+	for(uint64_t id = 0; id < aData.getNodes().size(); id++) byName.emplace(aData.getNodes()[id].name, id);
+
+	std::vector<int64_t> map(skeleton.joints.size(), -1);
+	for(uint64_t j = 0; j < skeleton.joints.size(); j++) {
+		auto node = byName.find(skeleton.joints[j].name);
+		if(node != byName.end()) map[j] = node->second;
+	}
+	return map;
+}
+
+RootMotion AnimationLibrary::getRootMotion(const RootMotion& aMotion, std::span<const int64_t> aNodeMap, const ModelData& aData, const Pose& aRest) noexcept {
+	RootMotion motion = aMotion;
+	motion.node = aMotion.node >= 0 && (uint64_t)aMotion.node < aNodeMap.size() ? aNodeMap[aMotion.node] : -1;
+	if(motion.node == -1) return {};
+
+	int64_t parent = aData.mNodes[motion.node].parent;
+	motion.toModel = parent != -1 ? glm::mat3(aRest.globalMatrix[parent]) : glm::mat3(1.0f);
+	motion.fromModel = glm::inverse(motion.toModel);
+	//source model space -> root's parent space -> ours, same rig = no change
+	glm::mat3 rebase = motion.toModel * aMotion.fromModel;
+	for(glm::vec3& d : motion.displacement) {
+		d = rebase * d;
+		d.y = 0.0f;
+	}
+	motion.loopDelta = motion.displacement.empty() ? glm::vec3(0.0f) : motion.displacement.back();
+	return motion;
+}
+
+bool AnimationLibrary::isSameClip(const Animation& aClip, const Animation& aOther) noexcept {
+	if(aClip.mName != aOther.mName || aClip.mStart != aOther.mStart || aClip.mEnd != aOther.mEnd) return false;
+	if(aClip.mSampleRate != aOther.mSampleRate || aClip.mResampleRate != aOther.mResampleRate) return false;
+
+	bool same = std::equal(aClip.mSamplers.begin(), aClip.mSamplers.end(), aOther.mSamplers.begin(), aOther.mSamplers.end(), [](const SamplerData& a, const SamplerData& b) {
+		return a.type == b.type && a.nodeIndex == b.nodeIndex && a.time == b.time && a.value == b.value;
+	});
+	same = same && std::equal(aClip.mTracks.begin(), aClip.mTracks.end(), aOther.mTracks.begin(), aOther.mTracks.end(), [](const CompressedTrack& a, const CompressedTrack& b) {
+		return a.type == b.type && a.node == b.node && a.minimum == b.minimum && a.extent == b.extent;
+	});
+	same = same && std::equal(aClip.mConstants.begin(), aClip.mConstants.end(), aOther.mConstants.begin(), aOther.mConstants.end(), [](const ConstantTrack& a, const ConstantTrack& b) {
+		return a.type == b.type && a.node == b.node && a.value == b.value;
+	});
+	same = same && std::equal(aClip.mChannels.begin(), aClip.mChannels.end(), aOther.mChannels.begin(), aOther.mChannels.end(), [](const ResampledChannel& a, const ResampledChannel& b) {
+		return a.type == b.type && a.node == b.node && a.offset == b.offset;
+	});
+	//segments follow from the key frames
+	return same && aClip.mKeyFrames == aOther.mKeyFrames && aClip.mKeyValues == aOther.mKeyValues && aClip.mPoseRows == aOther.mPoseRows;
+}
@@ -0,0 +1,61 @@
+#ifndef GLTF_ANIMATIONLIBRARY
+#define GLTF_ANIMATIONLIBRARY
+#include "ModelData.hpp"
+
+//clips shared between models with the same skeleton - loaded once, read-only, bound to each model's nodes by name
+
+struct SkeletonJoint {
+	std::string name;
+	int64_t parent; //index into Skeleton::joints, -1 = root
+};
+
+//skin joints and animated nodes of a file (every node if it has no skin)
+//clips loaded under a skeleton refer to its joint indices
+struct Skeleton {
+	std::vector<SkeletonJoint> joints;
+	uint64_t key = 0; //names and parent names, independent of joint order
+};
+
+class AnimationLibrary {
+public:
+	AnimationLibrary() noexcept;
+
+	//every clip of a .glb/.gltf under its skeleton - animation-only files work, images are never decoded
+	//the same file is only loaded once, returns the skeleton id (-1 on failure)
+	int64_t load(const std::filesystem::path& aPath) noexcept;
+	//moves aData's own clips into the library (clips with the same name and keys the skeleton already has are reused instead)
+	//aData keeps views of them under the same ids, returns the skeleton id (-1 if aData has no nodes)
+	int64_t share(ModelData& aData) noexcept;
+	//appends views of the skeleton's clips aData does not have yet (own clips by name, views by clip), returns how many
+	//joints are matched by name, those aData lacks are skipped - for models that are not the skeleton's source
+	uint64_t addClips(const uint64_t aSkeleton, ModelData& aData) const noexcept;
+
+	uint64_t getSkeletonAmount() const noexcept;
+	const Skeleton& getSkeleton(const uint64_t aSkeleton) const noexcept;
+	const std::vector<std::shared_ptr<const Animation>>& getClips(const uint64_t aSkeleton) const noexcept;
+	//key data of every clip in bytes
+	uint64_t getMemorySize() const noexcept;
+
+	~AnimationLibrary() noexcept;
+private:
+	struct Entry {
+		Skeleton skeleton;
+		std::vector<std::shared_ptr<const Animation>> clips;
+		std::vector<RootMotion> rootMotion; //per clip, from its source model (node = joint index)
+	};
+	std::vector<Entry> mEntries;
+	std::vector<std::pair<std::filesystem::path, uint64_t>> mLoaded; //file, skeleton id
+
+	//finds or adds aData's skeleton, aNodeToJoint maps aData's nodes to its joints (-1 = not a joint)
+	uint64_t addSkeleton(const ModelData& aData, std::vector<int64_t>& aNodeToJoint) noexcept;
+	//aData's clip aId into the library under aSkeleton (or the same one already there)
+	std::shared_ptr<const Animation> addClip(const uint64_t aSkeleton, ModelData& aData, const uint64_t aId, std::span<const int64_t> aNodeToJoint) noexcept;
+	//same name, range and keys, both already on skeleton joints
+	static bool isSameClip(const Animation& aClip, const Animation& aOther) noexcept;
+	//skeleton joint to aData node, by name
+	std::vector<int64_t> getNodeMap(const uint64_t aSkeleton, const ModelData& aData) const noexcept;
+	//aMotion on aData's nodes, rebased from its source model's space onto aData's rest pose aRest
+	static RootMotion getRootMotion(const RootMotion& aMotion, std::span<const int64_t> aNodeMap, const ModelData& aData, const Pose& aRest) noexcept;
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include "AnimationLibrary.hpp"
+#include <iostream>
+#include <string>
+
+//headless checks of AnimationLibrary on the sample models: clip dedup, views sampling like the model's own clips
+//and root motion of views
+//usage: gl3d_test_animation_library [asset directory]
+
+static uint64_t sFailed = 0;
+static uint64_t sPassed = 0;
+
+static void check(const bool aCondition, const std::string& aName) noexcept {
+	if(aCondition) {
+		sPassed++;
+		return;
+	}
+	sFailed++;
+	std::cerr << "Error: check " << aName << " failed!\n";
+}
+
+//largest local TRS difference of clip aId of aData and clip aReferenceId of aReference, at 30 Hz over the clip
+static float getClipError(const ModelData& aData, const uint64_t aId, const ModelData& aReference, const uint64_t aReferenceId) noexcept {
+	Pose pose, reference;
+	float error = 0.0f;
+	float duration = aReference.getAnimations()[aReferenceId].getDuration();
+	for(float t = 0.0f; t <= duration; t += 1.0f / 30.0f) {
+		aData.setStateAtTime(pose, aId, aData.getAnimations()[aId].getStart() + t);
+		aReference.setStateAtTime(reference, aReferenceId, aReference.getAnimations()[aReferenceId].getStart() + t);
+		for(uint64_t n = 0; n < reference.translation.size(); n++) {
+			error = std::max(error, glm::length(pose.translation[n] - reference.translation[n]));
+			error = std::max(error, glm::length(pose.scale[n] - reference.scale[n]));
+			const glm::quat& r = pose.rotation[n];
+			const glm::quat& q = reference.rotation[n];
+			error = std::max(error, glm::length(glm::vec4(r.x - q.x, r.y - q.y, r.z - q.z, r.w - q.w)));
+		}
+	}
+	return error;
+}
+
+//same root node (by name) and displacement curve
+static bool isSameRootMotion(const ModelData& aData, const uint64_t aId, const ModelData& aReference, const uint64_t aReferenceId) noexcept {
+	const RootMotion& motion = aData.getRootMotion(aId);
+	const RootMotion& reference = aReference.getRootMotion(aReferenceId);
+	if(motion.node == -1 || reference.node == -1) return motion.node == reference.node;
+	if(aData.getNodes()[motion.node].name != aReference.getNodes()[reference.node].name) return false;
+	if(motion.time != reference.time || motion.displacement.size() != reference.displacement.size()) return false;
+	for(uint64_t k = 0; k < motion.displacement.size(); k++) {
+		if(glm::length(motion.displacement[k] - reference.displacement[k]) > 1e-4f) return false;
+	}
+	return true;
+}
+
+//clip of aData named aName, -1 if none
+static int64_t findClip(const ModelData& aData, const std::string_view aName) noexcept {
+	for(uint64_t i = 0; i < aData.getAnimationAmount(); i++) if(aData.getAnimations()[i].getName() == aName) return i;
+	return -1;
+}
+
+int main(int argc, char** argv) {
+	std::filesystem::path directory = argc > 1 ? argv[1] : ".";
+	//loader logging is not what we check
+	std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+	AnimationLibrary library;
+	ModelData reference(directory / "Fox.glb");
+	int64_t skeleton = library.load(directory / "Fox.glb");
+
+	std::cout.rdbuf(coutBuffer);
+	check(skeleton >= 0 && reference.getAnimationAmount() == 3, "fox loaded");
+	if(skeleton < 0 || reference.getAnimationAmount() != 3) {
+		std::cout << "Animation library test: " << sPassed << " passed, " << sFailed << " failed\n";
+		return 1;
+	}
+	check(library.getClips(skeleton).size() == 3, "load adds every clip");
+	std::cout.rdbuf(nullptr);
+	int64_t again = library.load(directory / "Fox.glb");
+	std::cout.rdbuf(coutBuffer);
+	check(again == skeleton && library.getClips(skeleton).size() == 3, "second load reuses the file");
+
+	//the same clips shared from a model are the loaded ones, its views sample like its own clips did
+	{
+		std::cout.rdbuf(nullptr);
+		ModelData fox(directory / "Fox.glb");
+		int64_t shared = library.share(fox);
+		std::cout.rdbuf(coutBuffer);
+		check(shared == skeleton, "share finds the loaded skeleton");
+		check(library.getClips(skeleton).size() == 3, "share reuses clips with the same keys");
+		for(uint64_t i = 0; i < fox.getAnimationAmount(); i++) {
+			std::string name(fox.getAnimations()[i].getName());
+			check(fox.getAnimations()[i].isShared(), "view " + name);
+			check(getClipError(fox, i, reference, i) == 0.0f, "view samples like the own clip " + name);
+			check(isSameRootMotion(fox, i, reference, i), "view keeps root motion " + name);
+		}
+	}
+
+	//same names, other keys - kept apart
+	std::cout.rdbuf(nullptr);
+	ModelData compressed(directory / "Fox.glb");
+	compressed.compressAnimations({});
+	std::cout.rdbuf(coutBuffer);
+	uint64_t compressedClips = 0;
+	for(const Animation& a : compressed.getAnimations()) compressedClips += a.isCompressed();
+	check(compressedClips > 0, "fox compresses");
+	std::cout.rdbuf(nullptr);
+	library.share(compressed);
+	std::cout.rdbuf(coutBuffer);
+	check(library.getClips(skeleton).size() == 3 + compressedClips, "same-named clips with other keys are added");
+
+	//a foreign model with the same joints in another node order gets views bound by name,
+	//root motion of compressed clips comes from the library, there are no raw keys left
+	{
+		std::cout.rdbuf(nullptr);
+		ModelData foreign(directory / "FoxRE.glb");
+		uint64_t own = foreign.getAnimationAmount();
+		uint64_t sameNames = library.addClips(skeleton, foreign);
+		library.share(foreign);
+		uint64_t added = library.addClips(skeleton, foreign);
+		std::cout.rdbuf(coutBuffer);
+		check(sameNames == 0, "own clips skip same-named library clips");
+		//views of every library clip but its own, the compressed ones included
+		check(foreign.getAnimationAmount() == own + added && added == library.getClips(skeleton).size() - own, "views appended to a foreign model");
+
+		//compressed or not, a library clip carries the root motion of its source at load
+		for(uint64_t i = own; i < foreign.getAnimationAmount(); i++) {
+			std::string name(foreign.getAnimations()[i].getName());
+			int64_t source = findClip(reference, name);
+			check(source != -1 && foreign.getRootMotion(i).node != -1, "foreign view has root motion " + name);
+			check(source != -1 && isSameRootMotion(foreign, i, reference, source), "foreign view root motion matches its source " + name);
+		}
+	}
+
+	std::cout << "Animation library test: " << sPassed << " passed, " << sFailed << " failed\n";
+	return sFailed == 0 ? 0 : 1;
+}
@@ -0,0 +1,86 @@
+#include "Bake.hpp"
+
+//frames per job - one Fox palette is a few µs
+#define BAKE_JOB_GRAIN 8
+
+PaletteBake::PaletteBake() noexcept {}
+PaletteBake::PaletteBake(const ModelData& aData, const float aSampleRate, JobSystem* aJobs) noexcept
+: mpData(&aData), mSampleRate(aSampleRate) {
+	if(aSampleRate <= 0.0f) {
+		std::cerr << "Error: cannot bake palettes at " << aSampleRate << " Hz!\n";
+		this->mSampleRate = 0.0f;
+		return;
+	}
+	//unskinned models still get 1 matrix per frame, vertAnim.glsl reads it with weight 0
+	this->mJointAmount = std::max<uint64_t>(aData.getJointAmount(), 1);
+
+	uint64_t frameAmount = 0;
+	for(const Animation& a : aData.getAnimations()) {
+		float lastPosition = a.getDuration() * aSampleRate;
+		BakedClip clip = { frameAmount, (uint64_t)std::ceil(lastPosition - 1e-3f) + 1, lastPosition };
+		this->mClips.push_back(clip);
+		frameAmount += clip.frameAmount;
+	}
+	this->mJointMatrices.assign(frameAmount*this->mJointAmount, glm::mat4(1.0f));
+	this->mBounds.resize(frameAmount);
+
+	//(clip, frame) pairs flattened, frames are independent
+	std::vector<std::pair<uint32_t, uint32_t>> frames;
+	frames.reserve(frameAmount);
+	for(uint64_t c = 0; c < this->mClips.size(); c++) {
+		for(uint64_t f = 0; f < this->mClips[c].frameAmount; f++) frames.push_back({ (uint32_t)c, (uint32_t)f });
+	}
+	auto bake = [&](uint64_t aId) {
+		const BakedClip& clip = this->mClips[frames[aId].first];
+		const Animation& animation = aData.getAnimations()[frames[aId].first];
+		float time = std::min(animation.getStart() + std::min((float)frames[aId].second, clip.lastPosition) / aSampleRate, animation.getEnd());
+
+		Pose pose;
+		aData.setStateAtTime(pose, frames[aId].first, time);
+		std::span<glm::mat4> palette = std::span<glm::mat4>(this->mJointMatrices).subspan(aId*this->mJointAmount, aData.getJointAmount());
+		aData.getJointMatrices(pose, palette);
+		this->mBounds[aId] = aData.getBounds(palette);
+	};
+	if(aJobs) aJobs->parallelFor(frameAmount, BAKE_JOB_GRAIN, bake);
+	else for(uint64_t i = 0; i < frameAmount; i++) bake(i);
+
+	for(uint64_t c = 0; c < this->mClips.size(); c++) {
+		std::cout << "Baked animation: " << aData.getAnimations()[c].getName() << ", " << this->mClips[c].frameAmount << " frames, " << this->getClipMemorySize(c) << " bytes\n";
+	}
+}
+
+uint64_t PaletteBake::getFrame(const uint64_t aAnimation, const double aTime, const LoopMode aMode) const noexcept {
+	if(aAnimation >= this->mClips.size()) return 0;
+	const BakedClip& clip = this->mClips[aAnimation];
+	const Animation& animation = this->mpData->getAnimations()[aAnimation];
+	float position = (animation.getClipTime(aTime, aMode) - animation.getStart()) * this->mSampleRate;
+	return clip.firstFrame + std::min<uint64_t>(std::lround(std::max(position, 0.0f)), clip.frameAmount-1);
+}
+const BoundingBox& PaletteBake::getBounds(const uint64_t aFrame) const noexcept {
+	return this->mBounds[aFrame];
+}
+
+const std::vector<glm::mat4>& PaletteBake::getJointMatrices() const noexcept {
+	return this->mJointMatrices;
+}
+uint64_t PaletteBake::getJointAmount() const noexcept {
+	return this->mJointAmount;
+}
+uint64_t PaletteBake::getFrameAmount() const noexcept {
+	return this->mBounds.size();
+}
+const std::vector<BakedClip>& PaletteBake::getClips() const noexcept {
+	return this->mClips;
+}
+float PaletteBake::getSampleRate() const noexcept {
+	return this->mSampleRate;
+}
+uint64_t PaletteBake::getMemorySize() const noexcept {
+	return this->mJointMatrices.size()*sizeof(glm::mat4);
+}
+uint64_t PaletteBake::getClipMemorySize(const uint64_t aAnimation) const noexcept {
+	if(aAnimation >= this->mClips.size()) return 0;
+	return this->mClips[aAnimation].frameAmount*this->mJointAmount*sizeof(glm::mat4);
+}
+
+PaletteBake::~PaletteBake() noexcept {}
@@ -0,0 +1,44 @@
+#ifndef GLTF_BAKE
+#define GLTF_BAKE
+#include "ModelData.hpp"
+#include "JobSystem.hpp"
+
+//frames of one clip in a PaletteBake
+struct BakedClip {
+	uint64_t firstFrame;
+	uint64_t frameAmount;
+	float lastPosition; //clip end in frames, the last frame sits on it
+};
+
+//every clip's skinning palette precomputed at a fixed rate, for instances that play clips back unchanged
+//frame f is getJointAmount() matrices from f*getJointAmount(), uploaded once (Model::uploadBake) and indexed in vertAnim.glsl
+class PaletteBake {
+public:
+	PaletteBake() noexcept;
+	//aData must outlive the bake, frames are split over aJobs (nullptr = calling thread only)
+	PaletteBake(const ModelData& aData, const float aSampleRate = 30.0f, JobSystem* aJobs = nullptr) noexcept;
+
+	//nearest frame of clip aAnimation at playback time aTime, as an index for getJointMatrices/getBounds
+	uint64_t getFrame(const uint64_t aAnimation, const double aTime, const LoopMode aMode = LoopMode::LOOP) const noexcept;
+	const BoundingBox& getBounds(const uint64_t aFrame) const noexcept; //model space, skinned
+
+	const std::vector<glm::mat4>& getJointMatrices() const noexcept;
+	uint64_t getJointAmount() const noexcept; //matrices per frame
+	uint64_t getFrameAmount() const noexcept;
+	const std::vector<BakedClip>& getClips() const noexcept;
+	float getSampleRate() const noexcept;
+	//palettes in bytes, all clips or one
+	uint64_t getMemorySize() const noexcept;
+	uint64_t getClipMemorySize(const uint64_t aAnimation) const noexcept;
+
+	~PaletteBake() noexcept;
+private:
+	const ModelData* mpData = nullptr;
+	float mSampleRate = 0.0f;
+	uint64_t mJointAmount = 1;
+	std::vector<BakedClip> mClips;
+	std::vector<glm::mat4> mJointMatrices;
+	std::vector<BoundingBox> mBounds; //per frame
+};
+
+#endif
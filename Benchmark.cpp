@@ -0,0 +1,252 @@
+#include "Crowd.hpp"
+#include "Skinning.hpp"
+#include "AnimationGraph.hpp"
+#include "Retarget.hpp"
+
+//headless benchmark - runs on the GL-free core, so no window or GPU is needed
+//usage: gl3d_bench [iterations] [asset directory]
+//prints results as JSON to stdout, loader logging is silenced
+
+static const std::array<std::string_view, 4> BenchmarkModels = { "Fox.glb", "BoxAnimated.glb", "t3d1.glb", "T3dvere.glb" };
+static const uint64_t LoadIterations = 20;
+static const std::array<uint64_t, 5> CrowdThreads = { 1, 2, 4, 8, 16 };
+static const uint64_t CrowdSize = 512;
+
+struct BenchmarkResult {
+	std::string model;
+	std::string name;
+	std::vector<uint64_t> times; //ns per op
+	uint64_t threads = 1;
+};
+
+template<typename F>
+static BenchmarkResult runBenchmark(const std::string_view aModel, const std::string_view aName, const uint64_t aIterations, F&& aOperation) noexcept {
+	BenchmarkResult result = { std::string(aModel), std::string(aName), {} };
+	result.times.reserve(aIterations);
+	for(uint64_t i = 0; i < aIterations; i++) {
+		auto start = std::chrono::steady_clock::now();
+		aOperation(i);
+		auto end = std::chrono::steady_clock::now();
+		result.times.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+	}
+	return result;
+}
+
+//quoted JSON string, glTF names may hold quotes, backslashes and control characters
+static std::string getJSONString(const std::string_view aText) noexcept {
+	static const char* hex = "0123456789abcdef";
+	std::string result = "\"";
+	for(char c : aText) {
+		if(c == '"' || c == '\\') {
+			result += '\\';
+			result += c;
+		}
+		else if((unsigned char)c < 0x20) {
+			result += "\\u00";
+			result += hex[(unsigned char)c >> 4];
+			result += hex[c & 0xF];
+		}
+		else result += c;
+	}
+	return result + '"';
+}
+
+static void printResult(std::ostream& aStream, const BenchmarkResult& aResult) noexcept {
+	std::vector<uint64_t> sorted = aResult.times;
+	std::sort(sorted.begin(), sorted.end());
+	auto percentile = [&](const double aPercent) -> uint64_t {
+		if(sorted.empty()) return 0;
+		return sorted[(uint64_t)(aPercent * (sorted.size()-1))];
+	};
+	double total = std::accumulate(sorted.begin(), sorted.end(), 0.0);
+	double mean = sorted.empty() ? 0.0 : total / sorted.size();
+
+	aStream <<
+	"{\"model\":" << getJSONString(aResult.model) << ",\"benchmark\":" << getJSONString(aResult.name) <<
+	",\"threads\":" << aResult.threads <<
+	",\"iterations\":" << sorted.size() <<
+	",\"ns_per_op\":" << mean <<
+	",\"min\":" << percentile(0.0) <<
+	",\"p50\":" << percentile(0.5) <<
+	",\"p90\":" << percentile(0.9) <<
+	",\"p99\":" << percentile(0.99) <<
+	",\"max\":" << percentile(1.0) <<
+	",\"ops_per_second\":" << (mean > 0.0 ? 1e9/mean : 0.0) << '}';
+}
+
+int main(int argc, char** argv) {
+	uint64_t iterations = 10000;
+	if(argc > 1) iterations = std::max(std::strtoull(argv[1], nullptr, 10), 1ull);
+	std::filesystem::path directory = ".";
+	if(argc > 2) directory = argv[2];
+
+	//ModelData is chatty on stdout, keep it clean for the JSON
+	std::streambuf* coutBuffer = std::cout.rdbuf(nullptr);
+
+	std::vector<BenchmarkResult> results;
+	std::vector<std::pair<std::string, CompressionReport>> compression; //model, clip
+	std::vector<std::tuple<std::string, std::string, uint64_t, uint64_t>> bakes; //model, clip, frames, bytes
+	JobSystem loadJobs; //image decoding and mesh LODs
+	for(std::string_view name : BenchmarkModels) {
+		std::filesystem::path path = directory / name;
+		if(!std::filesystem::exists(path)) {
+			std::cerr << "Benchmark: " << path << " not found, skipping.\n";
+			continue;
+		}
+
+		results.push_back(runBenchmark(name, "load", LoadIterations, [&](uint64_t) {
+			ModelData model(path, nullptr, &loadJobs);
+		}));
+		results.back().threads = loadJobs.getThreadAmount();
+
+		ModelData model(path);
+		if(model.getAnimationAmount() == 0) continue;
+
+		Pose pose;
+		model.resetPose(pose);
+
+		//60 Hz steps, looping over the clip
+		results.push_back(runBenchmark(name, "setStateAtTime", iterations, [&](uint64_t aId) {
+			model.setStateAtTime(pose, 0, model.getAnimations()[0].getClipTime(aId/60.0));
+		}));
+
+		//same clip decoded from the compressed tracks, sizes and error go to "compression"
+		ModelData compressed(path);
+		for(const CompressionReport& r : compressed.compressAnimations()) compression.push_back({ std::string(name), r });
+		results.push_back(runBenchmark(name, "setStateAtTimeCompressed", iterations, [&](uint64_t aId) {
+			compressed.setStateAtTime(pose, 0, compressed.getAnimations()[0].getClipTime(aId/60.0));
+		}));
+
+		//and from pose rows at 30 Hz
+		ModelData resampled(path);
+		resampled.resampleAnimations(30.0f);
+		results.push_back(runBenchmark(name, "setStateAtTimeResampled", iterations, [&](uint64_t aId) {
+			resampled.setStateAtTime(pose, 0, resampled.getAnimations()[0].getClipTime(aId/60.0));
+		}));
+
+		//sampled and retargeted onto the same rig - the joint map cost on top of setStateAtTime
+		Retargeter retargeter(model, model);
+		Pose sourcePose;
+		results.push_back(runBenchmark(name, "setStateAtTimeRetargeted", iterations, [&](uint64_t aId) {
+			retargeter.setStateAtTime(sourcePose, pose, 0, model.getAnimations()[0].getClipTime(aId/60.0));
+		}));
+
+		//idle <-> 2 clip locomotion blend space, speed swept so fades and both blend paths occur
+		if(model.getAnimationAmount() >= 3) {
+			GraphDefinition definition;
+			definition.parameters = { "speed" };
+			definition.states = {
+				{ "idle", { { 0, 0.0f } }, "", 1.0f, {} },
+				{ "move", { { 1, 0.5f }, { 2, 1.0f } }, "speed", 1.0f, {} }
+			};
+			definition.transitions = {
+				{ "idle", "move", "speed", GraphCondition::GREATER, 0.1f, 0.0f, 0.3f },
+				{ "move", "idle", "speed", GraphCondition::LESS, 0.1f, 0.0f, 0.3f }
+			};
+			AnimationGraph graph(model, definition);
+			results.push_back(runBenchmark(name, "animationGraph", iterations, [&](uint64_t aId) {
+				graph.setParameter(0, 0.5f + 0.6f*std::sin(aId/120.0f));
+				graph.update(1.0f/60.0f);
+				graph.evaluate(pose);
+			}));
+		}
+
+		std::vector<glm::mat4> jointMatrices(model.getJointAmount());
+		results.push_back(runBenchmark(name, "jointMatrices", iterations, [&](uint64_t aId) {
+			model.getJointMatrices(pose, jointMatrices);
+		}));
+
+		//every mesh of the model per op (skinned models only), scalar reference against the SIMD kernels over thread counts
+		//SkinningTest checks that the kernels agree
+		if(model.getJointAmount() > 0) {
+			std::vector<SkinnedMesh> skinnedMeshes;
+			for(const MeshData& m : model.getMeshes()) skinnedMeshes.emplace_back(m);
+			std::vector<SkinnedVertices> skinnedVertices(skinnedMeshes.size());
+			results.push_back(runBenchmark(name, "cpuSkinScalar", std::max<uint64_t>(iterations/10, 10), [&](uint64_t) {
+				for(uint64_t i = 0; i < skinnedMeshes.size(); i++) skinnedMeshes[i].skinScalar(jointMatrices, skinnedVertices[i]);
+			}));
+			results.push_back(runBenchmark(name, "cpuSkinSSE", std::max<uint64_t>(iterations/10, 10), [&](uint64_t) {
+				for(uint64_t i = 0; i < skinnedMeshes.size(); i++) skinnedMeshes[i].skin(jointMatrices, skinnedVertices[i], nullptr, SkinningKernel::SSE);
+			}));
+			for(uint64_t threads : CrowdThreads) {
+				JobSystem jobs(threads);
+				results.push_back(runBenchmark(name, "cpuSkinSIMD", std::max<uint64_t>(iterations/10, 10), [&](uint64_t) {
+					for(uint64_t i = 0; i < skinnedMeshes.size(); i++) skinnedMeshes[i].skin(jointMatrices, skinnedVertices[i], &jobs);
+				}));
+				results.back().threads = threads;
+			}
+		}
+
+		//whole crowd per op - scaling over thread counts, ideal is 1/threads of the 1 thread time
+		Crowd crowd(model);
+		crowd.resize(CrowdSize);
+		for(uint64_t i = 0; i < CrowdSize; i++) crowd.getInstances()[i].timeOffset = (float)i / CrowdSize;
+		for(uint64_t threads : CrowdThreads) {
+			JobSystem jobs(threads);
+			results.push_back(runBenchmark(name, "crowdUpdate", std::max<uint64_t>(iterations/100, 10), [&](uint64_t aId) {
+				crowd.update(jobs, aId/60.0);
+			}));
+			results.back().threads = threads;
+		}
+
+		//every instance from baked palettes - frame lookup only
+		PaletteBake bake(model, 30.0f);
+		for(uint64_t i = 0; i < bake.getClips().size(); i++) bakes.push_back({ std::string(name), std::string(model.getAnimations()[i].getName()), bake.getClips()[i].frameAmount, bake.getClipMemorySize(i) });
+		crowd.setBake(&bake);
+		for(CrowdInstance& i : crowd.getInstances()) i.baked = true;
+		JobSystem bakedJobs(1);
+		results.push_back(runBenchmark(name, "crowdUpdateBaked", std::max<uint64_t>(iterations/100, 10), [&](uint64_t aId) {
+			crowd.update(bakedJobs, aId/60.0);
+		}));
+		for(CrowdInstance& i : crowd.getInstances()) i.baked = false;
+		crowd.setBake(nullptr);
+
+		//same crowd on a 150 unit grid seen from one side, so all animation LOD levels (and off-screen) occur
+		uint64_t side = std::ceil(std::sqrt((double)CrowdSize));
+		for(uint64_t i = 0; i < CrowdSize; i++) {
+			crowd.getInstances()[i].transform = glm::translate(glm::mat4(1.0f), glm::vec3((float)(i % side)*150.0f - side*75.0f, 0.0f, -200.0f - (float)(i / side)*150.0f));
+		}
+		glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.0f, 0.1f, 10000.0f);
+		glm::vec3 camera = glm::vec3(0.0f, 100.0f, 300.0f);
+		LODView view = { projection * glm::lookAt(camera, glm::vec3(0.0f, 0.0f, -1000.0f), glm::vec3(0.0f, 1.0f, 0.0f)), camera, projection[1][1] };
+		JobSystem lodJobs(1);
+		results.push_back(runBenchmark(name, "crowdUpdateLOD", std::max<uint64_t>(iterations/100, 10), [&](uint64_t aId) {
+			crowd.update(lodJobs, aId/60.0, &view);
+		}));
+	}
+
+	std::cout.rdbuf(coutBuffer);
+
+	std::cout << "{\"iterations\":" << iterations << ",\"results\":[\n";
+	for(uint64_t i = 0; i < results.size(); i++) {
+		printResult(std::cout, results[i]);
+		std::cout << (i+1 < results.size() ? ",\n" : "\n");
+	}
+	std::cout << "],\"compression\":[\n";
+	for(uint64_t i = 0; i < compression.size(); i++) {
+		const CompressionReport& r = compression[i].second;
+		std::cout <<
+		"{\"model\":" << getJSONString(compression[i].first) << ",\"animation\":" << getJSONString(r.name) <<
+		",\"raw_bytes\":" << r.rawBytes <<
+		",\"compressed_bytes\":" << r.compressedBytes <<
+		",\"ratio\":" << r.getRatio() <<
+		",\"raw_keys\":" << r.rawKeys <<
+		",\"compressed_keys\":" << r.compressedKeys <<
+		",\"tracks\":" << r.tracks <<
+		",\"raw_tracks\":" << r.rawTracks <<
+		",\"compressed\":" << (r.compressed ? "true" : "false") <<
+		",\"max_error\":" << r.maxError << '}';
+		std::cout << (i+1 < compression.size() ? ",\n" : "\n");
+	}
+	std::cout << "],\"bakes\":[\n";
+	for(uint64_t i = 0; i < bakes.size(); i++) {
+		std::cout <<
+		"{\"model\":" << getJSONString(std::get<0>(bakes[i])) << ",\"animation\":" << getJSONString(std::get<1>(bakes[i])) <<
+		",\"frames\":" << std::get<2>(bakes[i]) <<
+		",\"bytes\":" << std::get<3>(bakes[i]) << '}';
+		std::cout << (i+1 < bakes.size() ? ",\n" : "\n");
+	}
+	std::cout << "]}" << std::endl;
+
+	return 0;
+}
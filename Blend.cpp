@@ -0,0 +1,138 @@
+#include "Blend.hpp"
+
+//fades below this weight are dropped from blends
+#define BLEND_MIN_WEIGHT 1e-4f
+
+void blendPoses(Pose& aTarget, const Pose& aSource, const float aWeight) noexcept {
+	uint64_t nodes = std::min(aTarget.translation.size(), aSource.translation.size());
+	if(nodes == 0) return;
+
+	float* translation = glm::value_ptr(aTarget.translation[0]);
+	float* scale = glm::value_ptr(aTarget.scale[0]);
+	float* rotation = glm::value_ptr(aTarget.rotation[0]);
+	const float* sourceTranslation = glm::value_ptr(aSource.translation[0]);
+	const float* sourceScale = glm::value_ptr(aSource.scale[0]);
+	const float* sourceRotation = glm::value_ptr(aSource.rotation[0]);
+
+	for(uint64_t i = 0; i < nodes*3; i++) translation[i] += aWeight * (sourceTranslation[i] - translation[i]);
+	for(uint64_t i = 0; i < nodes*3; i++) scale[i] += aWeight * (sourceScale[i] - scale[i]);
+	for(uint64_t i = 0; i < nodes; i++) {
+		float* q = rotation + i*4;
+		const float* source = sourceRotation + i*4;
+		float dot = q[0]*source[0] + q[1]*source[1] + q[2]*source[2] + q[3]*source[3];
+		float weight = dot < 0.0f ? -aWeight : aWeight;
+		float length2 = 0.0f;
+		for(uint64_t c = 0; c < 4; c++) {
+			q[c] = (1.0f - aWeight) * q[c] + weight * source[c];
+			length2 += q[c]*q[c];
+		}
+		if(length2 > 0.0f) for(uint64_t c = 0; c < 4; c++) q[c] /= std::sqrt(length2);
+	}
+}
+
+AnimationBlender::AnimationBlender() noexcept {}
+
+void AnimationBlender::play(const uint64_t aAnimation, const float aNow, const float aDuration) noexcept {
+	if(!this->mFades.empty() && this->mFades.back().animation == aAnimation) return;
+	//nothing to fade from
+	float duration = this->mFades.empty() ? 0.0f : std::max(aDuration, 0.0f);
+	this->mFades.push_back({ aAnimation, aNow, duration });
+}
+
+void AnimationBlender::getClips(const float aNow, const float aClipTime, std::vector<BlendClip>& aClips) noexcept {
+	aClips.clear();
+
+	//newest first - whatever the newer fades leave over goes to the older ones
+	float remaining = 1.0f;
+	uint64_t firstAlive = this->mFades.size();
+	for(uint64_t i = this->mFades.size(); i-- > 0 && remaining > BLEND_MIN_WEIGHT;) {
+		const Fade& fade = this->mFades[i];
+		float fadeIn = fade.duration > 0.0f ? glm::clamp((aNow - fade.start) / fade.duration, 0.0f, 1.0f) : 1.0f;
+		if(i == 0) fadeIn = 1.0f; //oldest takes the rest
+
+		float weight = remaining * fadeIn;
+		remaining -= weight;
+		firstAlive = i;
+		if(weight > BLEND_MIN_WEIGHT) aClips.push_back({ fade.animation, aClipTime, weight });
+	}
+
+	//fully covered by newer fades, never heard from again
+	this->mFades.erase(this->mFades.begin(), this->mFades.begin() + firstAlive);
+}
+
+void AnimationBlender::blend(const ModelData& aData, Pose& aPose, std::span<const BlendClip> aClips, const uint64_t aJointLevel) noexcept {
+	if(aClips.empty()) {
+		aData.resetPose(aPose);
+		return;
+	}
+	//running weighted average - every clip goes in by its share of the weight so far
+	aData.setStateAtTime(aPose, aClips[0].animation, aClips[0].time, aJointLevel);
+	float totalWeight = std::max(aClips[0].weight, 0.0f);
+	for(uint64_t k = 1; k < aClips.size(); k++) {
+		if(aClips[k].weight <= 0.0f) continue;
+		totalWeight += aClips[k].weight;
+		aData.setStateAtTime(this->mClipPose, aClips[k].animation, aClips[k].time, aJointLevel);
+		blendPoses(aPose, this->mClipPose, aClips[k].weight / totalWeight);
+	}
+}
+
+void AnimationBlender::applyLayers(const ModelData& aData, Pose& aPose, std::span<const AnimationLayer> aLayers) noexcept {
+	if(this->mLayers.size() < aLayers.size()) this->mLayers.resize(aLayers.size());
+	uint64_t nodes = aData.getNodes().size();
+
+	for(uint64_t l = 0; l < aLayers.size(); l++) {
+		const AnimationLayer& layer = aLayers[l];
+		LayerState& state = this->mLayers[l];
+		if(layer.weight <= 0.0f || layer.animation >= aData.getAnimationAmount()) continue;
+
+		state.nodes.clear();
+		for(uint64_t i = 0; i < nodes; i++) if(layer.mask.empty() || (i < layer.mask.size() && layer.mask[i])) state.nodes.push_back(i);
+		if(state.nodes.empty()) continue;
+
+		this->sampleLayer(aData, state.pose, layer.animation, layer.time, layer.mask, state.nodes);
+		float weight = std::min(layer.weight, 1.0f);
+
+		if(layer.mode == LayerMode::OVERRIDE) {
+			for(uint64_t i : state.nodes) {
+				aPose.translation[i] = glm::mix(aPose.translation[i], state.pose.translation[i], weight);
+				aPose.rotation[i] = glm::slerp(aPose.rotation[i], state.pose.rotation[i], weight);
+				aPose.scale[i] = glm::mix(aPose.scale[i], state.pose.scale[i], weight);
+			}
+			continue;
+		}
+
+		//the reference does not move, sample it again only when the layer changes
+		if(state.referenceAnimation != layer.animation || state.referenceTime != layer.referenceTime || state.referenceMask != layer.mask || state.reference.translation.size() != nodes) {
+			this->sampleLayer(aData, state.reference, layer.animation, layer.referenceTime, layer.mask, state.nodes);
+			state.referenceAnimation = layer.animation;
+			state.referenceTime = layer.referenceTime;
+			state.referenceMask = layer.mask;
+		}
+		for(uint64_t i : state.nodes) {
+			glm::vec3 translation = state.pose.translation[i] - state.reference.translation[i];
+			glm::quat rotation = state.pose.rotation[i] * glm::inverse(state.reference.rotation[i]);
+			glm::vec3 scale = state.pose.scale[i] / glm::max(state.reference.scale[i], glm::vec3(1e-6f));
+
+			aPose.translation[i] += weight * translation;
+			aPose.rotation[i] = glm::normalize(glm::slerp(glm::quat(1.0f, 0.0f, 0.0f, 0.0f), rotation, weight) * aPose.rotation[i]);
+			aPose.scale[i] *= glm::mix(glm::vec3(1.0f), scale, weight);
+		}
+	}
+}
+
+int64_t AnimationBlender::getAnimation() const noexcept {
+	return this->mFades.empty() ? -1 : (int64_t)this->mFades.back().animation;
+}
+
+AnimationBlender::~AnimationBlender() noexcept {}
+
+void AnimationBlender::sampleLayer(const ModelData& aData, Pose& aPose, const uint64_t aAnimation, const float aTime, std::span<const uint8_t> aMask, std::span<const uint64_t> aNodes) noexcept {
+	const std::vector<Node>& nodes = aData.getNodes();
+	if(aPose.translation.size() != nodes.size()) aData.resetPose(aPose);
+	for(uint64_t i : aNodes) {
+		aPose.translation[i] = nodes[i].translation;
+		aPose.rotation[i] = nodes[i].rotation;
+		aPose.scale[i] = nodes[i].scale;
+	}
+	aData.getAnimations()[aAnimation].setStateAtTime(aPose, aTime, aMask);
+}
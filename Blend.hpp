@@ -0,0 +1,75 @@
+#ifndef GLTF_BLEND
+#define GLTF_BLEND
+#include "ModelData.hpp"
+
+//one clip of a blend, weights are normalized by AnimationBlender::blend
+struct BlendClip {
+	uint64_t animation;
+	float time;
+	float weight;
+};
+
+enum class LayerMode : uint8_t {
+	OVERRIDE = 0, //blends towards the layer's pose by its weight
+	ADDITIVE //adds the layer's difference to its reference pose, scaled by its weight
+};
+
+//clip applied over the blended pose, on the nodes of its mask only
+struct AnimationLayer {
+	uint64_t animation;
+	float time;
+	float weight = 1.0f;
+	LayerMode mode = LayerMode::OVERRIDE;
+	std::vector<uint8_t> mask; //Animation::setStateAtTime layout (see ModelData::getNodeMask), empty = every node, missing entries = 0
+	float referenceTime = 0.0f; //additive only, the clip at this time is "no change"
+};
+
+//aTarget = mix(aTarget, aSource, aWeight) on every node - lerp T/S, nlerp R
+void blendPoses(Pose& aTarget, const Pose& aSource, const float aWeight) noexcept;
+
+//crossfades between clips and blends several clips into one pose
+//each clip is sampled into a local pose and mixed into the result with blendPoses
+class AnimationBlender {
+public:
+	AnimationBlender() noexcept;
+
+	//fades from whatever plays at aNow to aAnimation over aDuration seconds (0 = snap)
+	//the clip already fading in last is left alone
+	void play(const uint64_t aAnimation, const float aNow, const float aDuration) noexcept;
+	//clips playing at aNow with their weights, each sampled at aClipTime - fades that are over are dropped
+	void getClips(const float aNow, const float aClipTime, std::vector<BlendClip>& aClips) noexcept;
+
+	//local TRS of aPose, global matrices are left to ModelData::getJointMatrices
+	void blend(const ModelData& aData, Pose& aPose, std::span<const BlendClip> aClips, const uint64_t aJointLevel = 0) noexcept;
+
+	//layers in order over aPose (e.g. the result of blend), channels outside a layer's mask are not sampled
+	void applyLayers(const ModelData& aData, Pose& aPose, std::span<const AnimationLayer> aLayers) noexcept;
+
+	//clip fading in last, -1 if nothing was played yet
+	int64_t getAnimation() const noexcept;
+
+	~AnimationBlender() noexcept;
+private:
+	struct Fade {
+		uint64_t animation;
+		float start;
+		float duration;
+	};
+	std::vector<Fade> mFades; //oldest first, every fade scales the ones before it by 1 - its weight
+	Pose mClipPose; //clip being blended in
+
+	struct LayerState {
+		Pose pose;
+		Pose reference; //additive layers
+		uint64_t referenceAnimation = UINT64_MAX;
+		float referenceTime = 0.0f;
+		std::vector<uint8_t> referenceMask;
+		std::vector<uint64_t> nodes; //masked nodes
+	};
+	std::vector<LayerState> mLayers;
+
+	//rest TRS of aNodes, then the clip on aMask
+	void sampleLayer(const ModelData& aData, Pose& aPose, const uint64_t aAnimation, const float aTime, std::span<const uint8_t> aMask, std::span<const uint64_t> aNodes) noexcept;
+};
+
+#endif
@@ -0,0 +1,73 @@
+#include "Bounds.hpp"
+
+void BoundingBox::extend(const glm::vec3& aPoint) noexcept {
+	this->min = glm::min(this->min, aPoint);
+	this->max = glm::max(this->max, aPoint);
+}
+void BoundingBox::extend(const BoundingBox& aBox) noexcept {
+	if(aBox.isEmpty()) return;
+	this->min = glm::min(this->min, aBox.min);
+	this->max = glm::max(this->max, aBox.max);
+}
+bool BoundingBox::isEmpty() const noexcept {
+	return this->min.x > this->max.x;
+}
+BoundingBox BoundingBox::transform(const glm::mat4& aMatrix) const noexcept {
+	if(this->isEmpty()) return *this;
+
+	//Arvo - per axis, take the smaller/larger product of each matrix element with min and max
+	BoundingBox result;
+	result.min = result.max = glm::vec3(aMatrix[3]);
+	for(int c = 0; c < 3; c++) {
+		glm::vec3 a = glm::vec3(aMatrix[c]) * this->min[c];
+		glm::vec3 b = glm::vec3(aMatrix[c]) * this->max[c];
+		result.min += glm::min(a, b);
+		result.max += glm::max(a, b);
+	}
+	return result;
+}
+
+BoundingSphere BoundingSphere::transform(const glm::mat4& aMatrix) const noexcept {
+	float scale = std::max({ glm::length(glm::vec3(aMatrix[0])), glm::length(glm::vec3(aMatrix[1])), glm::length(glm::vec3(aMatrix[2])) });
+	return { glm::vec3(aMatrix * glm::vec4(this->center, 1.0f)), this->radius * scale };
+}
+
+float getScreenCoverage(const BoundingBox& aWorldBox, const glm::vec3& aCameraPosition, const float aProjectionScale) noexcept {
+	if(aWorldBox.isEmpty()) return 0.0f;
+	glm::vec3 center = (aWorldBox.min + aWorldBox.max)*0.5f;
+	float radius = glm::length(aWorldBox.max - aWorldBox.min)*0.5f;
+	float distance = glm::distance(center, aCameraPosition);
+	if(distance <= radius) return FLT_MAX; //camera inside
+	return radius * aProjectionScale / distance;
+}
+
+Frustum::Frustum(const glm::mat4& aProjectionView) noexcept {
+	glm::vec4 row0 = glm::vec4(aProjectionView[0][0], aProjectionView[1][0], aProjectionView[2][0], aProjectionView[3][0]);
+	glm::vec4 row1 = glm::vec4(aProjectionView[0][1], aProjectionView[1][1], aProjectionView[2][1], aProjectionView[3][1]);
+	glm::vec4 row2 = glm::vec4(aProjectionView[0][2], aProjectionView[1][2], aProjectionView[2][2], aProjectionView[3][2]);
+	glm::vec4 row3 = glm::vec4(aProjectionView[0][3], aProjectionView[1][3], aProjectionView[2][3], aProjectionView[3][3]);
+
+	this->mPlanes[0] = row3 + row0; //left
+	this->mPlanes[1] = row3 - row0; //right
+	this->mPlanes[2] = row3 + row1; //bottom
+	this->mPlanes[3] = row3 - row1; //top
+	this->mPlanes[4] = row3 + row2; //near (GL depth -1..1)
+	this->mPlanes[5] = row3 - row2; //far
+}
+
+bool Frustum::isVisible(const BoundingBox& aBox) const noexcept {
+	if(aBox.isEmpty()) return false;
+
+	for(const glm::vec4& p : this->mPlanes) {
+		//corner furthest along the plane normal - if even that one is behind, the whole box is
+		glm::vec3 corner = glm::vec3(
+			p.x >= 0.0f ? aBox.max.x : aBox.min.x,
+			p.y >= 0.0f ? aBox.max.y : aBox.min.y,
+			p.z >= 0.0f ? aBox.max.z : aBox.min.z
+		);
+		if(glm::dot(glm::vec3(p), corner) + p.w < 0.0f) return false;
+	}
+	return true;
+}
+
+Frustum::~Frustum() noexcept {}
@@ -0,0 +1,48 @@
+#ifndef GLTF_BOUNDS
+#define GLTF_BOUNDS
+#include "Core.hpp"
+#include <cfloat>
+
+struct BoundingBox {
+	glm::vec3 min = glm::vec3(FLT_MAX);
+	glm::vec3 max = glm::vec3(-FLT_MAX);
+
+	void extend(const glm::vec3& aPoint) noexcept;
+	void extend(const BoundingBox& aBox) noexcept;
+	bool isEmpty() const noexcept;
+	//box around the transformed box
+	BoundingBox transform(const glm::mat4& aMatrix) const noexcept;
+};
+
+struct BoundingSphere {
+	glm::vec3 center = glm::vec3(0.0f);
+	float radius = 0.0f;
+
+	//palettes can scale, radius grows with the largest axis
+	BoundingSphere transform(const glm::mat4& aMatrix) const noexcept;
+};
+
+//sphere around every bind pose vertex a palette entry moves
+struct JointBounds {
+	uint32_t joint; //palette index
+	BoundingSphere sphere;
+};
+
+//bounding radius relative to half the screen height, for LOD selection
+//aProjectionScale is projection[1][1] (1/tan(fov/2))
+float getScreenCoverage(const BoundingBox& aWorldBox, const glm::vec3& aCameraPosition, const float aProjectionScale) noexcept;
+
+//planes taken straight from projection * view (Gribb/Hartmann), world space
+class Frustum {
+public:
+	Frustum(const glm::mat4& aProjectionView) noexcept;
+
+	//conservative - may keep boxes just outside a corner, never drops visible ones
+	bool isVisible(const BoundingBox& aBox) const noexcept;
+
+	~Frustum() noexcept;
+private:
+	std::array<glm::vec4, 6> mPlanes; //xyz normal pointing inside, w distance
+};
+
+#endif
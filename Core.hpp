@@ -0,0 +1,57 @@
+#ifndef GLTF_CORE
+#define GLTF_CORE
+
+//everything that does not need GL - glTF import, node hierarchy, animation, skinning palettes
+//must not include glad/GLFW/imgui, gl3d_core is built and linked without them
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/ext/matrix_transform.hpp>
+#include <glm/geometric.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
+#include <glm/gtx/vector_angle.hpp>
+#include <stbi/stb_image.h>
+#include <fastgltf/core.hpp>
+#include <fastgltf/tools.hpp>
+#include <fastgltf/base64.hpp>
+#include <fastgltf/glm_element_traits.hpp>
+#include <iostream>
+#include <fstream>
+#include <array>
+#include <vector>
+#include <chrono>
+#include <csignal> //can be helpful to raise interrupts when debugging
+#include <clocale>
+#include <thread>
+#include <list>
+#include <filesystem>
+#include <numeric>
+#include <random>
+#include <functional>
+#include <atomic>
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <span>
+#include <cstring>
+
+using namespace std::chrono_literals;
+
+#define FILE_READ_BLOCK_SIZE 8192
+
+std::string readFile(std::fstream& aStream, const std::string_view aFilepath) noexcept;
+
+std::ostream& operator<<(std::ostream& aStream, const glm::vec2& aVector) noexcept;
+std::ostream& operator<<(std::ostream& aStream, const glm::vec3& aVector) noexcept;
+std::ostream& operator<<(std::ostream& aStream, const glm::vec4& aVector) noexcept;
+
+std::ostream& operator<<(std::ostream& aStream, const glm::mat4& aMatrix) noexcept;
+
+glm::mat4 convertToGLM(const fastgltf::math::fmat4x4& aFrom) noexcept;
+glm::quat convertToGLM(const fastgltf::math::quat<float>& aFrom) noexcept;
+glm::vec3 convertToGLM(const fastgltf::math::vec<float, 3> aFrom) noexcept;
+glm::vec4 convertToGLM(const fastgltf::math::vec<float, 4> aFrom) noexcept;
+
+#endif
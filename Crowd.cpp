@@ -0,0 +1,150 @@
+#include "Crowd.hpp"
+
+//instances per job - one Fox is a few µs, keeps queue traffic low
+#define CROWD_JOB_GRAIN 4
+
+Crowd::Crowd(const ModelData& aData, const uint64_t aStrideAlignment) noexcept
+	: mpData(&aData), mFrame(0), mLastTime(0.0) {
+		//close - full rate, mid - half rate blended, far - quarter rate with fewer joints
+		this->mLODs = {
+			{ 0.25f, 1, false, 0 },
+			{ 0.10f, 2, true, 0 },
+			{ 0.04f, 4, true, 1 },
+			{ 0.00f, 4, false, 2 }
+		};
+
+		uint64_t alignment = std::max<uint64_t>(aStrideAlignment, 1);
+		this->mStride = std::max<uint64_t>((aData.getJointAmount() + alignment - 1) / alignment * alignment, alignment);
+	}
+
+void Crowd::resize(const uint64_t aAmount) noexcept {
+	uint64_t oldAmount = this->mInstances.size();
+	this->mInstances.resize(aAmount);
+	for(uint64_t i = oldAmount; i < aAmount; i++) {
+		this->mpData->resetPose(this->mInstances[i].pose);
+		this->mInstances[i].bounds = this->mpData->getBounds({}); //bind pose until the first update, so LOD can see it
+	}
+	this->mJointMatrices.resize(aAmount*this->mStride, glm::mat4(1.0f));
+}
+std::vector<CrowdInstance>& Crowd::getInstances() noexcept {
+	return this->mInstances;
+}
+const std::vector<CrowdInstance>& Crowd::getInstances() const noexcept {
+	return this->mInstances;
+}
+
+void Crowd::update(JobSystem& aJobs, const double aTime, const LODView* aView) noexcept {
+	uint64_t jointAmount = this->mpData->getJointAmount();
+	double frameTime = aTime > this->mLastTime ? aTime - this->mLastTime : 1.0/60.0;
+	this->mLastTime = aTime;
+	Frustum frustum(aView ? aView->projectionView : glm::mat4(1.0f));
+
+	aJobs.parallelFor(this->mInstances.size(), CROWD_JOB_GRAIN, [&](uint64_t aId) {
+		CrowdInstance& instance = this->mInstances[aId];
+		std::span<glm::mat4> jointMatrices = std::span<glm::mat4>(this->mJointMatrices).subspan(aId*this->mStride, jointAmount);
+		double time = aTime*instance.speed + instance.timeOffset;
+
+		//baked - a frame index and the bounds baked with it, LOD only picks the mesh level
+		if(instance.baked && this->mpBake) {
+			instance.bakedFrame = this->mpBake->getFrame(instance.animation, time, instance.loopMode);
+			instance.bounds = this->mpBake->getBounds(instance.bakedFrame);
+			if(aView && !this->mLODs.empty()) instance.lod = this->selectLOD(instance, *aView, frustum);
+			return;
+		}
+
+		if(!aView || this->mLODs.empty()) {
+			this->evaluate(instance, time, 0, jointMatrices);
+			return;
+		}
+
+		//time is absolute, so off-screen instances advance just by not being evaluated
+		uint8_t previousLod = instance.lod;
+		instance.lod = this->selectLOD(instance, *aView, frustum);
+		if(instance.lod == CROWD_LOD_OFFSCREEN) return;
+
+		const AnimationLOD& lod = this->mLODs[instance.lod];
+		bool changed = previousLod != instance.lod;
+		bool due = changed || lod.updateInterval <= 1 || (this->mFrame + aId) % lod.updateInterval == 0;
+
+		if(!lod.interpolate) {
+			if(due) this->evaluate(instance, time, lod.jointLevel, jointMatrices);
+			return;
+		}
+
+		if(due) {
+			if(changed || instance.nextPalette.size() != jointAmount) {
+				instance.nextPalette.resize(jointAmount);
+				this->evaluate(instance, time, lod.jointLevel, instance.nextPalette);
+			}
+			//evaluate where we will be at the next update, blend towards it until then
+			std::swap(instance.previousPalette, instance.nextPalette);
+			instance.nextPalette.resize(jointAmount);
+			BoundingBox previousBounds = instance.bounds;
+			this->evaluate(instance, time + lod.updateInterval*frameTime*instance.speed, lod.jointLevel, instance.nextPalette);
+			instance.bounds.extend(previousBounds);
+			instance.interpolationStart = this->mFrame;
+		}
+
+		float weight = std::min((float)(this->mFrame - instance.interpolationStart) / lod.updateInterval, 1.0f);
+		for(uint64_t j = 0; j < jointAmount; j++) {
+			jointMatrices[j] = instance.previousPalette[j]*(1.0f - weight) + instance.nextPalette[j]*weight;
+		}
+	});
+
+	this->mFrame++;
+}
+
+void Crowd::setBake(const PaletteBake* aBake) noexcept {
+	this->mpBake = aBake;
+}
+const PaletteBake* Crowd::getBake() const noexcept {
+	return this->mpBake;
+}
+
+void Crowd::setLODs(const std::vector<AnimationLOD>& aLODs) noexcept {
+	this->mLODs = aLODs;
+	for(CrowdInstance& i : this->mInstances) i.lod = 0;
+}
+const std::vector<AnimationLOD>& Crowd::getLODs() const noexcept {
+	return this->mLODs;
+}
+
+void Crowd::getVisible(const Frustum& aFrustum, std::vector<uint64_t>& aVisible) const noexcept {
+	aVisible.clear();
+	for(uint64_t i = 0; i < this->mInstances.size(); i++) {
+		if(aFrustum.isVisible(this->mInstances[i].bounds.transform(this->mInstances[i].transform))) aVisible.push_back(i);
+	}
+}
+
+const std::vector<glm::mat4>& Crowd::getJointMatrices() const noexcept {
+	return this->mJointMatrices;
+}
+uint64_t Crowd::getStride() const noexcept {
+	return this->mStride;
+}
+uint64_t Crowd::getAmount() const noexcept {
+	return this->mInstances.size();
+}
+
+Crowd::~Crowd() noexcept {}
+
+uint8_t Crowd::selectLOD(CrowdInstance& aInstance, const LODView& aView, const Frustum& aFrustum) const noexcept {
+	//bounds of the last evaluation - they trail the pose, but only by the update interval
+	BoundingBox world = aInstance.bounds.transform(aInstance.transform);
+	if(!aFrustum.isVisible(world)) return CROWD_LOD_OFFSCREEN;
+
+	float coverage = getScreenCoverage(world, aView.cameraPosition, aView.projectionScale);
+	aInstance.meshLod = ModelData::getMeshLOD(coverage);
+
+	for(uint64_t i = 0; i < this->mLODs.size(); i++) {
+		if(coverage >= this->mLODs[i].minCoverage) return i;
+	}
+	return this->mLODs.size()-1;
+}
+
+void Crowd::evaluate(CrowdInstance& aInstance, const double aTime, const uint64_t aJointLevel, std::span<glm::mat4> aJointMatrices) const noexcept {
+	float clipTime = aInstance.animation < this->mpData->getAnimationAmount() ? this->mpData->getAnimations()[aInstance.animation].getClipTime(aTime, aInstance.loopMode) : 0.0f;
+	this->mpData->setStateAtTime(aInstance.pose, aInstance.animation, clipTime, aJointLevel);
+	this->mpData->getJointMatrices(aInstance.pose, aJointMatrices);
+	aInstance.bounds = this->mpData->getBounds(aJointMatrices);
+}
@@ -0,0 +1,89 @@
+#ifndef GLTF_CROWD
+#define GLTF_CROWD
+#include "Bake.hpp"
+
+#define CROWD_LOD_OFFSCREEN 0xFF
+
+//one animation level of detail, picked by screen coverage
+struct AnimationLOD {
+	float minCoverage; //bounding radius relative to half the screen height
+	uint8_t updateInterval; //evaluate every n-th frame (staggered between instances)
+	bool interpolate; //blend palettes between evaluations instead of holding the last one
+	uint8_t jointLevel; //ModelData::setStateAtTime joint level
+};
+
+//camera the LOD is chosen for
+struct LODView {
+	glm::mat4 projectionView;
+	glm::vec3 cameraPosition;
+	float projectionScale; //projection[1][1], 1/tan(fov/2)
+};
+
+struct CrowdInstance {
+	uint64_t animation = 0;
+	float timeOffset = 0.0f; //seconds
+	float speed = 1.0f;
+	LoopMode loopMode = LoopMode::LOOP;
+	glm::mat4 transform = glm::mat4(1.0f);
+	Pose pose;
+	BoundingBox bounds; //model space, skinned bounds of the last update
+
+	uint8_t lod = 0; //index into Crowd::getLODs or CROWD_LOD_OFFSCREEN
+	uint8_t meshLod = 0; //ModelData::getMeshLOD, picked together with lod
+	uint64_t interpolationStart = 0; //frame of the last evaluation
+	std::vector<glm::mat4> previousPalette, nextPalette; //only used by interpolating LODs
+
+	bool baked = false; //plays from Crowd::setBake's palettes - not evaluated, its getJointMatrices slice is left alone
+	uint64_t bakedFrame = 0; //PaletteBake frame, set by update
+};
+
+//many animated instances of one ModelData
+//every instance writes its palette into its own slice of one joint buffer, so updates need no locking
+class Crowd {
+public:
+	//slice stride is rounded up to aStrideAlignment matrices (for glBindBufferRange offsets)
+	Crowd(const ModelData& aData, const uint64_t aStrideAlignment = 1) noexcept;
+
+	void resize(const uint64_t aAmount) noexcept;
+	std::vector<CrowdInstance>& getInstances() noexcept;
+	const std::vector<CrowdInstance>& getInstances() const noexcept;
+
+	//samples, evaluates and writes palettes of all instances
+	//with aView, per instance LOD: reduced rate/joints and mesh LOD by screen coverage, off-screen ones only advance time
+	//aTime in seconds, kept double so long sessions do not drift
+	void update(JobSystem& aJobs, const double aTime, const LODView* aView = nullptr) noexcept;
+
+	//palettes for baked instances, must outlive the crowd (nullptr = every instance is evaluated)
+	void setBake(const PaletteBake* aBake) noexcept;
+	const PaletteBake* getBake() const noexcept;
+
+	//sorted by minCoverage, largest first - last one should start at 0
+	void setLODs(const std::vector<AnimationLOD>& aLODs) noexcept;
+	const std::vector<AnimationLOD>& getLODs() const noexcept;
+
+	//ids of instances whose last updated bounds touch the frustum
+	void getVisible(const Frustum& aFrustum, std::vector<uint64_t>& aVisible) const noexcept;
+
+	//instance i starts at getStride()*i
+	const std::vector<glm::mat4>& getJointMatrices() const noexcept;
+	uint64_t getStride() const noexcept;
+	uint64_t getAmount() const noexcept;
+
+	~Crowd() noexcept;
+private:
+	const ModelData* mpData;
+	const PaletteBake* mpBake = nullptr;
+	std::vector<CrowdInstance> mInstances;
+	std::vector<glm::mat4> mJointMatrices;
+	uint64_t mStride;
+
+	std::vector<AnimationLOD> mLODs;
+	uint64_t mFrame;
+	double mLastTime;
+
+	uint8_t selectLOD(CrowdInstance& aInstance, const LODView& aView, const Frustum& aFrustum) const noexcept;
+	//aTime is playback time, looped by the instance's clip
+	void evaluate(CrowdInstance& aInstance, const double aTime, const uint64_t aJointLevel, std::span<glm::mat4> aJointMatrices) const noexcept;
+};
+
+#endif
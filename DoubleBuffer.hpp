@@ -0,0 +1,62 @@
+#ifndef GLTF_DOUBLEBUFFER
+#define GLTF_DOUBLEBUFFER
+#include "Core.hpp"
+
+//lock-free handoff between one producer (simulation) and one consumer (render) thread
+//the producer fills frame N+1 while the consumer still reads frame N, frames are consumed in order
+//both sides only block (atomic wait) when the other one is a whole frame behind
+template<typename T>
+class DoubleBuffer {
+public:
+	DoubleBuffer() noexcept : mPublished(0), mConsumed(0), mClosed(false), mWriteId(0), mReadId(0) {}
+	DoubleBuffer(DoubleBuffer& aOther) noexcept = delete;
+	DoubleBuffer& operator=(DoubleBuffer& aOther) noexcept = delete;
+
+	//producer - waits until the consumer released the slot (frame N-2), previous contents are left in place for reuse
+	T& beginWrite() noexcept {
+		while(true) {
+			uint64_t consumed = this->mConsumed.load(std::memory_order_acquire);
+			if(consumed + 2 > this->mWriteId) break;
+			this->mConsumed.wait(consumed, std::memory_order_acquire);
+		}
+		return this->mFrames[this->mWriteId % 2];
+	}
+	void endWrite() noexcept {
+		this->mWriteId++;
+		this->mPublished.store(this->mWriteId, std::memory_order_release);
+		this->mPublished.notify_one();
+	}
+
+	//consumer - nullptr once closed
+	T* beginRead() noexcept {
+		while(true) {
+			if(this->mClosed.load(std::memory_order_acquire)) return nullptr;
+			uint64_t published = this->mPublished.load(std::memory_order_acquire);
+			if(published > this->mReadId) break;
+			this->mPublished.wait(published, std::memory_order_acquire);
+		}
+		return &this->mFrames[this->mReadId % 2];
+	}
+	void endRead() noexcept {
+		this->mReadId++;
+		this->mConsumed.store(this->mReadId, std::memory_order_release);
+		this->mConsumed.notify_one();
+	}
+
+	//producer side, wakes up the consumer for good
+	void close() noexcept {
+		this->mClosed.store(true, std::memory_order_release);
+		this->mPublished.store(UINT64_MAX, std::memory_order_release);
+		this->mPublished.notify_one();
+	}
+
+	~DoubleBuffer() noexcept {}
+private:
+	std::array<T, 2> mFrames;
+	std::atomic<uint64_t> mPublished, mConsumed; //frame counts
+	std::atomic<bool> mClosed;
+	uint64_t mWriteId; //producer only
+	uint64_t mReadId; //consumer only
+};
+
+#endif
@@ -1,4 +1,47 @@
 #include "Model.hpp"
+#include "DoubleBuffer.hpp"
+#include "Blend.hpp"
+
+//imgui draw data outlives the frame it was built in - the render thread submits it while the next one is built
+struct GuiDrawData {
+	ImDrawData data;
+
+	void copy(const ImDrawData* aData) noexcept {
+		this->clear();
+		this->data = *aData;
+		this->data.CmdLists.resize(0);
+		for(ImDrawList* l : aData->CmdLists) this->data.CmdLists.push_back(l->CloneOutput());
+	}
+	void clear() noexcept {
+		for(ImDrawList* l : this->data.CmdLists) IM_DELETE(l);
+		this->data.CmdLists.resize(0);
+	}
+	~GuiDrawData() noexcept {
+		this->clear();
+	}
+};
+
+//everything the render thread needs for one frame, filled by the simulation thread
+struct Frame {
+	glm::mat4 projectionView;
+	glm::mat4 modelTransform = glm::mat4(1.0f); //main model, moved by root motion
+	bool renderBase;
+	std::vector<glm::mat4> jointMatrices;
+
+	std::vector<glm::mat4> crowdJointMatrices;
+	uint64_t crowdStride = 1;
+	std::vector<glm::mat4> crowdTransforms;
+	std::vector<uint8_t> crowdMeshLODs;
+	const PaletteBake* bake = nullptr; //baked crowd instances, uploaded once when it changes
+	std::vector<uint64_t> crowdBakedFrames;
+	std::vector<glm::mat4> crowdBakedTransforms;
+	std::vector<uint8_t> crowdBakedMeshLODs;
+	uint64_t meshLOD = 0;
+	bool computeSkinning = false;
+	SkinningMode skinningMode = SkinningMode::MATRIX;
+
+	GuiDrawData gui;
+};
 
 void GLDebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const void* userParam) {
 	std::cerr << "OpenGL ";
@@ -179,7 +222,9 @@ int main() {
 	ImGui_ImplGlfw_InitForOpenGL(window, true);
 	ImGui_ImplOpenGL3_Init("#version 450 core");
 
-	Model m(std::filesystem::path("./Fox.glb"));
+	//loading, then the crowd, animated on all cores
+	JobSystem jobs;
+	Model m(std::filesystem::path("./Fox.glb"), &jobs);
 
 	GLint samplers[] = {
 		0, 1, 2, 3, 4, 5, 6, 7, 8, 9,
@@ -196,6 +241,19 @@ int main() {
 	sa.bind();
 	glUniform1iv(16, 32, &samplers[0]);
 
+	Shader saf("vertAnimAffine.glsl", "fragAnim.glsl");
+	saf.bind();
+	glUniform1iv(16, 32, &samplers[0]);
+	Shader sdq("vertAnimDQ.glsl", "fragAnim.glsl");
+	sdq.bind();
+	glUniform1iv(16, 32, &samplers[0]);
+
+	//compute skinning - skinned once per frame, passthrough vertex shader afterwards
+	Shader skin("compSkin.glsl");
+	Shader ss("vertSkinned.glsl", "fragAnim.glsl");
+	ss.bind();
+	glUniform1iv(16, 32, &samplers[0]);
+
 	glm::mat4 matrix;
 	glm::mat4 proj = glm::mat4(1.0f);
 	proj = glm::perspective(glm::radians((float)FOV), 800.0f/800.0f, 0.1f, 1000.0f);
@@ -203,54 +261,255 @@ int main() {
 
 	bool renderBase = false;
 	bool overrideAnimTime = false;
-	float animTime = 0.0;
+	float animTime = 0.0; //key time of the current clip
+	AnimationPlayback playback; //time, rate and loop mode of the main model
+	int loopMode = 0; //LoopMode
+	double lastTime = glfwGetTime();
 	int animId = 0;
+	float crossfadeTime = 0.3f;
+	AnimationBlender blender;
+	std::vector<BlendClip> blendClips;
+	//one layer over the blend, masked to the subtree of a node
+	bool useLayer = false;
+	bool layerAdditive = false;
+	int layerAnimation = 0;
+	int layerRoot = 0;
+	int layerMaskRoot = -1; //what the mask was built for
+	std::array<AnimationLayer, 1> layers = {};
+	//root motion - the model walks through the world, its root stays in place in the pose
+	bool useRootMotion = false;
+	glm::vec3 rootPosition = glm::vec3(0.0f);
+	std::vector<BlendClip> previousClips; //last frame's blend, each clip's previous time
+
+	//instances on a grid behind the main model
+	Crowd crowd(m.getData(), Model::getJointStrideAlignment());
+	int crowdSize = 0;
+	float crowdUpdateTime = 0.0f;
+	std::vector<uint64_t> crowdVisible;
+	bool useAnimationLOD = true;
+	bool bakeCrowd = false; //background instances from precomputed palettes, baked on first use
+	std::unique_ptr<PaletteBake> bake;
+	int meshLOD = 0; //main model only, crowd picks by screen size
+	bool computeSkinning = false; //main model only
+	int skinningMode = 0; //SkinningMode, main model only
+
+	//GL objects are ready - from here on the context belongs to the render thread
+	//this thread polls input, animates and builds the GUI for frame N+1 while frame N is submitted
+	ImGui_ImplOpenGL3_NewFrame(); //creates the imgui device objects while we still have the context
+	glfwMakeContextCurrent(nullptr);
+
+	DoubleBuffer<Frame> frames;
+	std::atomic<float> renderTime = 0.0f;
+	std::thread renderThread([&]() {
+		glfwMakeContextCurrent(window);
+		const PaletteBake* uploadedBake = nullptr;
+		while(Frame* frame = frames.beginRead()) {
+			auto start = std::chrono::steady_clock::now();
+
+			glClearColor(0.3f, 0.3f, 0.3f, 1.0f);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			if(frame->renderBase) {
+				//base model
+				s.bind();
+				m.draw(frame->projectionView * frame->modelTransform, frame->jointMatrices, frame->meshLOD);
+			}
+
+			//animated model
+			m.setSkinningMode(frame->skinningMode);
+			if(frame->computeSkinning) {
+				m.skin(skin, frame->jointMatrices);
+				ss.bind();
+				m.drawSkinned(frame->projectionView * frame->modelTransform, frame->jointMatrices, frame->meshLOD);
+			}
+			else {
+				if(frame->skinningMode == SkinningMode::AFFINE) saf.bind();
+				else if(frame->skinningMode == SkinningMode::DUAL_QUATERNION) sdq.bind();
+				else sa.bind();
+				m.draw(frame->projectionView * frame->modelTransform, frame->jointMatrices, frame->meshLOD);
+			}
+			sa.bind();
+			m.drawInstances(frame->projectionView, frame->crowdJointMatrices, frame->crowdStride, frame->crowdTransforms, frame->crowdMeshLODs);
+			if(frame->bake && frame->bake != uploadedBake) {
+				m.uploadBake(*frame->bake);
+				uploadedBake = frame->bake;
+			}
+			if(frame->bake) m.drawBaked(frame->projectionView, frame->crowdBakedFrames, frame->crowdBakedTransforms, frame->crowdBakedMeshLODs);
+
+			ImGui_ImplOpenGL3_RenderDrawData(&frame->gui.data);
+
+			renderTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+			frames.endRead();
+			glfwSwapBuffers(window);
+		}
+		glfwMakeContextCurrent(nullptr);
+	});
+
+	float simTime = 0.0f;
     while (!glfwWindowShouldClose(window) && !closeWindow) {
-		ImGui_ImplOpenGL3_NewFrame();
+		auto start = std::chrono::steady_clock::now();
+		glfwPollEvents();
+
 		ImGui_ImplGlfw_NewFrame();
 		ImGui::NewFrame();
 
-        glClearColor(0.3f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		Frame& frame = frames.beginWrite();
 
 		//camera
 		glm::vec3 camera_pos = glm::vec3(CameraXOffset, CameraYOffset, CameraZOffset);
 		view = glm::lookAt(camera_pos, camera_pos + Direction, glm::vec3(0.0, 1.0, 0.0));
 
 		matrix = proj * view;
-
+		frame.projectionView = matrix;
+		frame.renderBase = renderBase;
+		frame.meshLOD = meshLOD;
+		frame.computeSkinning = computeSkinning;
+		frame.skinningMode = (SkinningMode)skinningMode;
+
+		double now = glfwGetTime();
+		const std::vector<Animation>& animations = m.getData().getAnimations();
+		playback.animation = animId;
+		playback.mode = (LoopMode)loopMode;
 		if(!overrideAnimTime) {
-			animTime = std::fmod(glfwGetTime(), 1.0);
+			playback.advance(now - lastTime);
+			if(playback.animation < animations.size()) animTime = animations[playback.animation].getClipTime(playback.time, playback.mode);
 		}
-		m.setStateAtTime(animId, animTime);
-
-		if(renderBase) {
-			//base model
-			s.bind();
-			m.draw(matrix);
+		lastTime = now;
+
+		blender.play(animId, now, crossfadeTime);
+		blender.getClips(now, animTime, blendClips);
+		//clips fading out loop on their own length
+		if(!overrideAnimTime) for(BlendClip& c : blendClips) c.time = animations[c.animation].getClipTime(playback.time, playback.mode);
+		blender.blend(m.getData(), m.getPose(), blendClips);
+		if(useRootMotion && m.getAnimationAmount() > 0) {
+			//every clip by its share of the blend, from its own previous time
+			float totalWeight = 0.0f;
+			for(const BlendClip& c : blendClips) totalWeight += c.weight;
+			for(const BlendClip& c : blendClips) {
+				float weight = totalWeight > 0.0f ? c.weight / totalWeight : 0.0f;
+				//clips that just started fading in move from where they are
+				auto previous = std::find_if(previousClips.begin(), previousClips.end(), [&](const BlendClip& p) { return p.animation == c.animation; });
+				//a backwards step reads as a loop, so only plain forward looping accumulates
+				if(previous != previousClips.end() && !overrideAnimTime && playback.mode == LoopMode::LOOP && playback.rate > 0.0f) {
+					rootPosition += weight * m.getData().getRootMotionDelta(c.animation, previous->time, c.time);
+				}
+				m.getData().removeRootMotion(m.getPose(), c.animation, c.time, weight);
+			}
+		}
+		previousClips = blendClips;
+		frame.modelTransform = glm::translate(glm::mat4(1.0f), rootPosition);
+		if(useLayer && m.getAnimationAmount() > 0) {
+			if(layerMaskRoot != layerRoot) {
+				m.getData().getNodeMask(layerRoot, layers[0].mask);
+				layerMaskRoot = layerRoot;
+			}
+			layers[0].animation = layerAnimation;
+			layers[0].time = overrideAnimTime ? animTime : animations[layerAnimation].getClipTime(playback.time, playback.mode);
+			layers[0].mode = layerAdditive ? LayerMode::ADDITIVE : LayerMode::OVERRIDE;
+			blender.applyLayers(m.getData(), m.getPose(), layers);
+		}
+		m.getJointMatrices(frame.jointMatrices);
+
+		if((uint64_t)crowdSize != crowd.getAmount()) {
+			crowd.resize(crowdSize);
+			std::vector<CrowdInstance>& instances = crowd.getInstances();
+			uint64_t side = std::ceil(std::sqrt((double)instances.size()));
+			for(uint64_t i = 0; i < instances.size(); i++) {
+				instances[i].transform = glm::translate(glm::mat4(1.0f), glm::vec3((float)(i % side)*150.0f - side*75.0f, 0.0f, -200.0f - (float)(i / side)*150.0f));
+				instances[i].timeOffset = (float)(i % 7) / 7.0f;
+				instances[i].animation = m.getAnimationAmount() > 0 ? i % m.getAnimationAmount() : 0;
+			}
+		}
+		if(bakeCrowd && !bake) {
+			bake = std::make_unique<PaletteBake>(m.getData(), 30.0f, &jobs);
+			crowd.setBake(bake.get());
+		}
+		for(CrowdInstance& i : crowd.getInstances()) i.baked = bakeCrowd;
+		frame.bake = bake.get();
+		frame.crowdTransforms.clear();
+		frame.crowdMeshLODs.clear();
+		frame.crowdJointMatrices.clear();
+		frame.crowdBakedFrames.clear();
+		frame.crowdBakedTransforms.clear();
+		frame.crowdBakedMeshLODs.clear();
+		if(crowd.getAmount() > 0) {
+			auto crowdStart = std::chrono::steady_clock::now();
+			LODView lodView = { matrix, camera_pos, proj[1][1] };
+			crowd.update(jobs, now, useAnimationLOD ? &lodView : nullptr);
+			crowdUpdateTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - crowdStart).count();
+
+			//off-screen instances are left out of the frame, so their joints are never uploaded
+			crowd.getVisible(Frustum(matrix), crowdVisible);
+			//baked ones only send their frame
+			frame.crowdStride = crowd.getStride();
+			for(uint64_t id : crowdVisible) {
+				const CrowdInstance& instance = crowd.getInstances()[id];
+				if(instance.baked && bake) {
+					frame.crowdBakedFrames.push_back(instance.bakedFrame);
+					frame.crowdBakedTransforms.push_back(instance.transform);
+					frame.crowdBakedMeshLODs.push_back(instance.meshLod);
+					continue;
+				}
+				frame.crowdTransforms.push_back(instance.transform);
+				frame.crowdMeshLODs.push_back(instance.meshLod);
+				auto slice = crowd.getJointMatrices().begin() + id*crowd.getStride();
+				frame.crowdJointMatrices.insert(frame.crowdJointMatrices.end(), slice, slice + crowd.getStride());
+			}
 		}
-
-		//animated model
-		sa.bind();
-		m.draw(matrix);
 
 		//gui for control and debugging
 		ImGui::Begin("Anim control");
-		//when changing id everything breaks
 		ImGui::SliderInt("ID of animation", &animId, 0, m.getAnimationAmount()-1);
+		ImGui::SliderFloat("Crossfade seconds", &crossfadeTime, 0, 2.0);
+		ImGui::Text("Blending %llu clips", (unsigned long long)blendClips.size());
+		ImGui::Checkbox("Root motion", &useRootMotion);
+		ImGui::SameLine();
+		if(ImGui::Button("Reset position")) rootPosition = glm::vec3(0.0f);
+		ImGui::Checkbox("Layer", &useLayer);
+		if(useLayer && !m.getData().getNodes().empty()) {
+			ImGui::SliderInt("Layer animation", &layerAnimation, 0, m.getAnimationAmount()-1);
+			ImGui::SliderFloat("Layer weight", &layers[0].weight, 0, 1.0);
+			ImGui::Checkbox("Layer additive", &layerAdditive);
+			ImGui::SliderInt("Layer mask root", &layerRoot, 0, m.getData().getNodes().size()-1);
+			ImGui::Text("Mask root: %s", m.getData().getNodes()[layerRoot].name.c_str());
+		}
 		ImGui::SliderFloat("Speed of camera", &SPEED, 0, 1.0);
 		ImGui::Checkbox("Render base model", &renderBase);
 		ImGui::Checkbox("Override time", &overrideAnimTime);
-		ImGui::SliderFloat("Anim seconds", &animTime, 0, 3.3333);
+		if(m.getAnimationAmount() > 0) {
+			const Animation& clip = m.getData().getAnimations()[animId];
+			ImGui::SliderFloat("Anim seconds", &animTime, clip.getStart(), clip.getEnd());
+		}
+		ImGui::SliderFloat("Playback rate", &playback.rate, 0, 3.0);
+		ImGui::Combo("Loop mode", &loopMode, "Loop\0Clamp\0Ping-pong\0");
+		ImGui::SliderInt("Mesh LOD", &meshLOD, 0, m.getMeshLODAmount()-1);
+		ImGui::Checkbox("Compute skinning", &computeSkinning);
+		ImGui::Combo("Skinning palette", &skinningMode, "Matrix\0Affine 3x4\0Dual quaternion\0");
+		ImGui::SliderInt("Crowd size", &crowdSize, 0, 1024);
+		ImGui::Text("Crowd update: %.3f ms on %llu threads", crowdUpdateTime, (unsigned long long)jobs.getThreadAmount());
+		ImGui::Text("Crowd visible: %llu of %llu", (unsigned long long)(frame.crowdTransforms.size() + frame.crowdBakedTransforms.size()), (unsigned long long)crowd.getAmount());
+		ImGui::Checkbox("Bake crowd palettes", &bakeCrowd);
+		if(bake) ImGui::Text("Baked palettes: %llu frames, %llu KiB", (unsigned long long)bake->getFrameAmount(), (unsigned long long)bake->getMemorySize()/1024);
+		ImGui::Checkbox("Animation LOD", &useAnimationLOD);
+		if(useAnimationLOD) {
+			std::array<uint64_t, 5> lodCounts = {};
+			for(const CrowdInstance& i : crowd.getInstances()) lodCounts[std::min<uint64_t>(i.lod, lodCounts.size()-1)]++;
+			ImGui::Text("LOD 0-3: %llu %llu %llu %llu, off-screen %llu", (unsigned long long)lodCounts[0], (unsigned long long)lodCounts[1], (unsigned long long)lodCounts[2], (unsigned long long)lodCounts[3], (unsigned long long)lodCounts[4]);
+		}
+		ImGui::Text("Simulation %.3f ms, render submission %.3f ms", simTime, renderTime.load());
+		ImGui::Text("Texture memory: CPU %llu KiB, GPU %llu KiB", (unsigned long long)Texture::getTotalCpuMemory()/1024, (unsigned long long)Texture::getTotalGpuMemory()/1024);
 		ImGui::End();
 
 		ImGui::Render();
-		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+		frame.gui.copy(ImGui::GetDrawData());
 
-        glfwSwapBuffers(window);
-        glfwPollEvents();
+		simTime = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		frames.endWrite();
     }
 
+	frames.close();
+	renderThread.join();
+
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,37 @@
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_WINDOWS_UTF8
+#define STBI_FAILURE_USERMSG
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "Image.hpp"
+
+TextureData::TextureData(const void* aData, const size_t aSize, const bool aFlip) noexcept
+	: pixels(nullptr), width(0), height(0), channels(0), flipped(aFlip) {
+		//per thread flag, decoding runs on worker threads
+		stbi_set_flip_vertically_on_load_thread(aFlip);
+		this->pixels = stbi_load_from_memory((const stbi_uc*)aData, aSize, &this->width, &this->height, &this->channels, 4);
+		if(!this->pixels) {
+			std::cerr << "STBI failed to load image from memory! (" << stbi_failure_reason() << ")\n";
+		}
+	}
+TextureData::TextureData(TextureData&& aOther) noexcept
+	: pixels(aOther.pixels), width(aOther.width), height(aOther.height), channels(aOther.channels), flipped(aOther.flipped) {
+		aOther.pixels = nullptr;
+	}
+TextureData& TextureData::operator=(TextureData&& aOther) noexcept {
+	stbi_image_free(this->pixels);
+	this->pixels = aOther.pixels;
+	this->width = aOther.width;
+	this->height = aOther.height;
+	this->channels = aOther.channels;
+	this->flipped = aOther.flipped;
+	aOther.pixels = nullptr;
+	return *this;
+}
+TextureData::~TextureData() noexcept {
+	stbi_image_free(this->pixels);
+}
+
+std::string getImageKey(const void* aData, const size_t aSize) noexcept {
+	size_t hash = std::hash<std::string_view>{}(std::string_view((const char*)aData, aSize));
+	return "embedded:" + std::to_string(hash) + ':' + std::to_string(aSize);
+}
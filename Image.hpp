@@ -0,0 +1,35 @@
+#ifndef GLTF_IMAGE
+#define GLTF_IMAGE
+#include "Core.hpp"
+#include "KTX2.hpp"
+
+//CPU side stbi result - decoding is thread safe, uploading (Texture constructor) is not
+struct TextureData {
+	uint8_t* pixels; //always RGBA8
+	int32_t width, height, channels;
+	bool flipped;
+
+	TextureData() noexcept : pixels(nullptr), width(0), height(0), channels(0), flipped(true) {}
+	TextureData(const void* aData, const size_t aSize, const bool aFlip = true) noexcept;
+	TextureData(TextureData&& aOther) noexcept;
+	TextureData& operator=(TextureData&& aOther) noexcept;
+	TextureData(TextureData& aOther) noexcept = delete;
+	TextureData& operator=(TextureData& aOther) noexcept = delete;
+	~TextureData() noexcept;
+};
+
+//one image of a model, decoded (or precompressed) and ready for upload
+struct ImageData {
+	std::string key; //TextureCache key - canonical file path or getImageKey()
+	bool valid = false;
+	bool skipped = false; //loaded elsewhere already (see ModelData image filter), nothing decoded
+
+	TextureData pixels; //used if ktx has no levels
+	KTX2Image ktx;
+	std::vector<std::byte> ktxBytes; //ktx level views point in here
+};
+
+//content based key for embedded images, so the same image in two assets is shared too
+std::string getImageKey(const void* aData, const size_t aSize) noexcept;
+
+#endif
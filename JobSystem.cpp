@@ -0,0 +1,99 @@
+#include "JobSystem.hpp"
+
+JobSystem::JobSystem(const uint64_t aThreadAmount) noexcept
+	: mRunning(true), mPending(0) {
+		uint64_t threadAmount = aThreadAmount;
+		if(threadAmount == 0) threadAmount = std::max(std::thread::hardware_concurrency(), 1u);
+
+		for(uint64_t i = 0; i < threadAmount; i++) this->mQueues.push_back(std::make_unique<Queue>());
+		for(uint64_t i = 1; i < threadAmount; i++) this->mWorkers.emplace_back(&JobSystem::work, this, i);
+	}
+
+void JobSystem::parallelFor(const uint64_t aAmount, const uint64_t aGrain, const std::function<void(uint64_t)>& aJob) noexcept {
+	if(aAmount == 0) return;
+	uint64_t grain = std::max<uint64_t>(aGrain, 1);
+	uint64_t jobAmount = (aAmount + grain - 1) / grain;
+
+	if(this->mWorkers.empty() || jobAmount == 1) {
+		for(uint64_t i = 0; i < aAmount; i++) aJob(i);
+		return;
+	}
+
+	//deal the chunks out round robin, stealing evens out the rest
+	std::atomic<uint64_t> remaining = jobAmount;
+	for(uint64_t j = 0; j < jobAmount; j++) {
+		Queue& queue = *this->mQueues[j % this->mQueues.size()];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.jobs.push_back({ &aJob, j*grain, std::min((j+1)*grain, aAmount), &remaining });
+	}
+	{
+		std::lock_guard<std::mutex> lock(this->mSleepMutex);
+		this->mPending += jobAmount;
+	}
+	this->mSleep.notify_all();
+
+	Job job;
+	while(remaining.load(std::memory_order_acquire) > 0) {
+		if(this->popJob(0, job)) this->runJob(job);
+		else std::this_thread::yield(); //last chunks still running elsewhere
+	}
+}
+
+uint64_t JobSystem::getThreadAmount() const noexcept {
+	return this->mQueues.size();
+}
+
+JobSystem::~JobSystem() noexcept {
+	{
+		std::lock_guard<std::mutex> lock(this->mSleepMutex);
+		this->mRunning = false;
+	}
+	this->mSleep.notify_all();
+	for(std::thread& w : this->mWorkers) w.join();
+}
+
+bool JobSystem::popJob(const uint64_t aQueue, Job& aJob) noexcept {
+	if(this->mPending.load(std::memory_order_acquire) == 0) return false;
+
+	{
+		Queue& own = *this->mQueues[aQueue];
+		std::lock_guard<std::mutex> lock(own.mutex);
+		if(!own.jobs.empty()) {
+			aJob = own.jobs.back();
+			own.jobs.pop_back();
+			this->mPending--;
+			return true;
+		}
+	}
+
+	for(uint64_t i = 1; i < this->mQueues.size(); i++) {
+		Queue& victim = *this->mQueues[(aQueue + i) % this->mQueues.size()];
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if(!victim.jobs.empty()) {
+			aJob = victim.jobs.front();
+			victim.jobs.pop_front();
+			this->mPending--;
+			return true;
+		}
+	}
+	return false;
+}
+
+void JobSystem::runJob(const Job& aJob) noexcept {
+	for(uint64_t i = aJob.begin; i < aJob.end; i++) (*aJob.function)(i);
+	aJob.remaining->fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::work(const uint64_t aQueue) noexcept {
+	Job job;
+	while(true) {
+		if(this->popJob(aQueue, job)) {
+			this->runJob(job);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(this->mSleepMutex);
+		this->mSleep.wait(lock, [&]() { return this->mPending > 0 || !this->mRunning; });
+		if(!this->mRunning) return;
+	}
+}
@@ -0,0 +1,49 @@
+#ifndef GLTF_JOBSYSTEM
+#define GLTF_JOBSYSTEM
+#include "Core.hpp"
+#include <deque>
+#include <condition_variable>
+
+//work-stealing thread pool - every thread has its own queue, idle threads steal from the others
+//parallelFor blocks and the calling thread works too, so 1 thread = everything on the caller
+//one caller at a time, jobs must not call parallelFor themselves
+class JobSystem {
+public:
+	//0 = one thread per core
+	JobSystem(const uint64_t aThreadAmount = 0) noexcept;
+	JobSystem(JobSystem& aOther) noexcept = delete;
+	JobSystem& operator=(JobSystem& aOther) noexcept = delete;
+
+	//runs aJob(i) for every i in 0..aAmount-1, in chunks of aGrain ids
+	void parallelFor(const uint64_t aAmount, const uint64_t aGrain, const std::function<void(uint64_t)>& aJob) noexcept;
+
+	//including the calling thread
+	uint64_t getThreadAmount() const noexcept;
+
+	~JobSystem() noexcept;
+private:
+	struct Job {
+		const std::function<void(uint64_t)>* function;
+		uint64_t begin, end;
+		std::atomic<uint64_t>* remaining;
+	};
+	struct Queue {
+		std::mutex mutex;
+		std::deque<Job> jobs;
+	};
+
+	std::vector<std::unique_ptr<Queue>> mQueues; //0 = calling thread, 1.. = workers
+	std::vector<std::thread> mWorkers;
+
+	std::atomic<bool> mRunning;
+	std::atomic<uint64_t> mPending; //jobs queued and not taken yet
+	std::mutex mSleepMutex;
+	std::condition_variable mSleep;
+
+	//own queue from the back (last pushed, still in cache), others from the front
+	bool popJob(const uint64_t aQueue, Job& aJob) noexcept;
+	void runJob(const Job& aJob) noexcept;
+	void work(const uint64_t aQueue) noexcept;
+};
+
+#endif
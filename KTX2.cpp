@@ -0,0 +1,194 @@
+#include "KTX2.hpp"
+#include <cstring>
+#include <algorithm>
+#include <iostream>
+#ifdef GLTF_ZSTD
+#include <zstd.h>
+#endif
+
+//https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html
+
+static const uint8_t KTX2Identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+//identifier + 9 uint32 fields + dfd/kvd (4 uint32) + sgd (2 uint64)
+static const size_t KTX2HeaderSize = 12 + 9*4 + 4*4 + 2*8;
+static const size_t KTX2LevelIndexEntrySize = 3*8;
+
+static uint32_t readU32(const uint8_t* aPtr) noexcept {
+	uint32_t value;
+	memcpy(&value, aPtr, sizeof(uint32_t)); //KTX2 is little endian, as are all our targets
+	return value;
+}
+static uint64_t readU64(const uint8_t* aPtr) noexcept {
+	uint64_t value;
+	memcpy(&value, aPtr, sizeof(uint64_t));
+	return value;
+}
+
+static KTX2Format getFormatFromVulkan(const uint32_t aVkFormat) noexcept {
+	switch(aVkFormat) {
+		case(37):  return KTX2Format::RGBA8;          //VK_FORMAT_R8G8B8A8_UNORM
+		case(43):  return KTX2Format::RGBA8_SRGB;     //VK_FORMAT_R8G8B8A8_SRGB
+		case(131): //VK_FORMAT_BC1_RGB_UNORM_BLOCK
+		case(133): return KTX2Format::BC1;            //VK_FORMAT_BC1_RGBA_UNORM_BLOCK
+		case(132): //VK_FORMAT_BC1_RGB_SRGB_BLOCK
+		case(134): return KTX2Format::BC1_SRGB;       //VK_FORMAT_BC1_RGBA_SRGB_BLOCK
+		case(137): return KTX2Format::BC3;            //VK_FORMAT_BC3_UNORM_BLOCK
+		case(138): return KTX2Format::BC3_SRGB;       //VK_FORMAT_BC3_SRGB_BLOCK
+		case(139): return KTX2Format::BC4;            //VK_FORMAT_BC4_UNORM_BLOCK
+		case(141): return KTX2Format::BC5;            //VK_FORMAT_BC5_UNORM_BLOCK
+		case(145): return KTX2Format::BC7;            //VK_FORMAT_BC7_UNORM_BLOCK
+		case(146): return KTX2Format::BC7_SRGB;       //VK_FORMAT_BC7_SRGB_BLOCK
+		case(147): return KTX2Format::ETC2_RGB;       //VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK
+		case(148): return KTX2Format::ETC2_RGB_SRGB;  //VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK
+		case(151): return KTX2Format::ETC2_RGBA;      //VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK
+		case(152): return KTX2Format::ETC2_RGBA_SRGB; //VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK
+		default:   return KTX2Format::UNSUPPORTED;
+	}
+}
+
+bool KTX2Image::isCompressed() const noexcept {
+	return this->format != KTX2Format::RGBA8 && this->format != KTX2Format::RGBA8_SRGB && this->format != KTX2Format::UNSUPPORTED;
+}
+uint64_t KTX2Image::getByteSize() const noexcept {
+	uint64_t size = 0;
+	for(const KTX2Level& l : this->levels) size += l.size;
+	return size;
+}
+
+bool isKTX2(const void* aData, const size_t aSize) noexcept {
+	return aSize >= sizeof(KTX2Identifier) && memcmp(aData, KTX2Identifier, sizeof(KTX2Identifier)) == 0;
+}
+
+uint32_t getKTX2BlockSize(const KTX2Format aFormat) noexcept {
+	switch(aFormat) {
+		case(KTX2Format::RGBA8):
+		case(KTX2Format::RGBA8_SRGB):
+			return 4;
+		case(KTX2Format::BC1):
+		case(KTX2Format::BC1_SRGB):
+		case(KTX2Format::BC4):
+		case(KTX2Format::ETC2_RGB):
+		case(KTX2Format::ETC2_RGB_SRGB):
+			return 8;
+		case(KTX2Format::BC3):
+		case(KTX2Format::BC3_SRGB):
+		case(KTX2Format::BC5):
+		case(KTX2Format::BC7):
+		case(KTX2Format::BC7_SRGB):
+		case(KTX2Format::ETC2_RGBA):
+		case(KTX2Format::ETC2_RGBA_SRGB):
+			return 16;
+		default:
+			return 0;
+	}
+}
+
+bool parseKTX2(const void* aData, const size_t aSize, KTX2Image& aImage) noexcept {
+	const uint8_t* bytes = (const uint8_t*)aData;
+	if(!isKTX2(aData, aSize) || aSize < KTX2HeaderSize) {
+		std::cerr << "Error: not a KTX2 file!\n";
+		return false;
+	}
+
+	const uint8_t* header = bytes + sizeof(KTX2Identifier);
+	aImage.vkFormat = readU32(header + 0);
+	aImage.width = readU32(header + 8);
+	aImage.height = readU32(header + 12);
+	uint32_t depth = readU32(header + 16);
+	uint32_t layers = readU32(header + 20);
+	uint32_t faces = readU32(header + 24);
+	uint32_t levelAmount = std::max(readU32(header + 28), 1u); //0 = generate mipmaps, we just take the base
+	aImage.supercompression = (KTX2Supercompression)readU32(header + 32);
+	aImage.format = getFormatFromVulkan(aImage.vkFormat);
+
+	if(depth > 1 || layers > 1 || faces != 1) {
+		std::cerr << "Error: KTX2 arrays, cubemaps and 3D textures are not supported!\n";
+		return false;
+	}
+	if(aImage.supercompression == KTX2Supercompression::BASIS_LZ || aImage.vkFormat == 0) {
+		//ETC1S (BasisLZ) and UASTC (vkFormat undefined) would need transcoding
+		std::cerr << "Error: KTX2 holds Basis Universal data, only precompressed KTX2 is supported!\n";
+		return false;
+	}
+	bool supercompressionSupported = aImage.supercompression == KTX2Supercompression::NONE;
+#ifdef GLTF_ZSTD
+	supercompressionSupported |= aImage.supercompression == KTX2Supercompression::ZSTD;
+#endif
+	if(!supercompressionSupported) {
+		std::cerr << "Error: KTX2 supercompression scheme " << (uint32_t)aImage.supercompression << " is not supported!\n";
+		return false;
+	}
+	if(aImage.format == KTX2Format::UNSUPPORTED) {
+		std::cerr << "Error: KTX2 vkFormat " << aImage.vkFormat << " is not supported!\n";
+		return false;
+	}
+	if(aImage.width == 0 || aImage.width > KTX2_MAX_SIZE || aImage.height > KTX2_MAX_SIZE || levelAmount > 32) {
+		std::cerr << "Error: KTX2 size " << aImage.width << 'x' << aImage.height << " with " << levelAmount << " levels is not supported!\n";
+		return false;
+	}
+	if(KTX2HeaderSize + levelAmount*KTX2LevelIndexEntrySize > aSize) {
+		std::cerr << "Error: KTX2 level index out of range!\n";
+		return false;
+	}
+
+	uint32_t blockBytes = getKTX2BlockSize(aImage.format);
+	bool supercompressed = aImage.supercompression == KTX2Supercompression::ZSTD;
+	aImage.levels.clear();
+	aImage.levels.reserve(levelAmount);
+	aImage.inflated.clear();
+	std::vector<const uint8_t*> sources; //compressed bytes of each level, for the zstd pass
+	std::vector<uint64_t> sourceSizes;
+
+	const uint8_t* levelIndex = bytes + KTX2HeaderSize;
+	for(uint32_t i = 0; i < levelAmount; i++) {
+		KTX2Level level;
+		uint64_t offset = readU64(levelIndex + i*KTX2LevelIndexEntrySize);
+		uint64_t size = readU64(levelIndex + i*KTX2LevelIndexEntrySize + 8);
+		uint64_t uncompressedSize = readU64(levelIndex + i*KTX2LevelIndexEntrySize + 16);
+		level.width = std::max(aImage.width >> i, 1u);
+		level.height = std::max(aImage.height >> i, 1u);
+
+		uint64_t expected;
+		if(aImage.isCompressed()) {
+			expected = (uint64_t)((level.width+3)/4) * ((level.height+3)/4) * blockBytes;
+		}
+		else {
+			expected = (uint64_t)level.width * level.height * blockBytes;
+		}
+
+		//offset + size could wrap on hostile headers
+		if(offset > aSize || size > aSize - offset || (supercompressed ? uncompressedSize != expected : size < expected)) {
+			std::cerr << "Error: KTX2 level " << i << " is truncated!\n";
+			return false;
+		}
+		level.data = bytes + offset;
+		level.size = expected;
+		aImage.levels.push_back(level);
+
+		sources.push_back(bytes + offset);
+		sourceSizes.push_back(size);
+	}
+
+#ifdef GLTF_ZSTD
+	//every level is its own zstd frame, sized exactly by the level index
+	if(supercompressed) {
+		aImage.inflated.resize(aImage.getByteSize());
+		uint64_t position = 0;
+		for(uint32_t i = 0; i < levelAmount; i++) {
+			KTX2Level& level = aImage.levels[i];
+			size_t result = ZSTD_decompress(aImage.inflated.data() + position, level.size, sources[i], sourceSizes[i]);
+			if(ZSTD_isError(result) || result != level.size) {
+				std::cerr << "Error: KTX2 level " << i << " failed to decompress (" << (ZSTD_isError(result) ? ZSTD_getErrorName(result) : "wrong size") << ")!\n";
+				aImage.levels.clear();
+				aImage.inflated.clear();
+				return false;
+			}
+			level.data = aImage.inflated.data() + position;
+			position += level.size;
+		}
+	}
+#endif
+
+	return true;
+}
@@ -0,0 +1,66 @@
+#ifndef GLTF_KTX2
+#define GLTF_KTX2
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+//precompressed KTX2 loading - BCn, ETC2 and RGBA8 mip chains, zstd supercompressed ones if built with zstd
+//no Basis Universal transcoding: ETC1S/UASTC payloads (KHR_texture_basisu) are rejected
+//pure CPU, no GL calls - texel data is only referenced, not copied (unless it has to be decompressed)
+
+enum class KTX2Format : uint8_t {
+	UNSUPPORTED = 0,
+	RGBA8,
+	RGBA8_SRGB,
+	BC1,
+	BC1_SRGB,
+	BC3,
+	BC3_SRGB,
+	BC4,
+	BC5,
+	BC7,
+	BC7_SRGB,
+	ETC2_RGB,
+	ETC2_RGB_SRGB,
+	ETC2_RGBA,
+	ETC2_RGBA_SRGB
+};
+
+enum class KTX2Supercompression : uint32_t {
+	NONE = 0,
+	BASIS_LZ,
+	ZSTD,
+	ZLIB
+};
+
+struct KTX2Level {
+	const uint8_t* data = nullptr;
+	uint64_t size = 0;
+	uint32_t width = 0, height = 0;
+};
+
+struct KTX2Image {
+	KTX2Format format = KTX2Format::UNSUPPORTED;
+	KTX2Supercompression supercompression = KTX2Supercompression::NONE;
+	uint32_t vkFormat = 0;
+	uint32_t width = 0, height = 0;
+	std::vector<KTX2Level> levels; //level 0 = full resolution
+	std::vector<uint8_t> inflated; //decompressed levels of supercompressed files, their views point in here
+
+	bool isCompressed() const noexcept;
+	uint64_t getByteSize() const noexcept;
+};
+
+bool isKTX2(const void* aData, const size_t aSize) noexcept;
+
+//fills aImage with views into aData, which must outlive it (zstd levels are decompressed into aImage instead)
+//returns false (and prints why) for malformed files and formats we cannot upload directly
+bool parseKTX2(const void* aData, const size_t aSize, KTX2Image& aImage) noexcept;
+
+//largest width/height accepted, also bounds what a hostile header can make us allocate
+#define KTX2_MAX_SIZE 16384
+
+//bytes per 4x4 block for compressed formats, bytes per pixel for RGBA8
+uint32_t getKTX2BlockSize(const KTX2Format aFormat) noexcept;
+
+#endif
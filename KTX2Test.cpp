@@ -0,0 +1,160 @@
+#include "KTX2.hpp"
+#include <cstring>
+#include <iostream>
+#include <string>
+#ifdef GLTF_ZSTD
+#include <zstd.h>
+#endif
+
+//headless checks of parseKTX2 on files built in memory
+
+static uint64_t sFailed = 0;
+static uint64_t sPassed = 0;
+
+static void check(const bool aCondition, const std::string& aName) noexcept {
+	if(aCondition) {
+		sPassed++;
+		return;
+	}
+	sFailed++;
+	std::cerr << "Error: check " << aName << " failed!\n";
+}
+
+static void writeU32(std::vector<uint8_t>& aFile, const uint64_t aOffset, const uint32_t aValue) noexcept {
+	memcpy(aFile.data() + aOffset, &aValue, sizeof(uint32_t));
+}
+static void writeU64(std::vector<uint8_t>& aFile, const uint64_t aOffset, const uint64_t aValue) noexcept {
+	memcpy(aFile.data() + aOffset, &aValue, sizeof(uint64_t));
+}
+
+//KTX2 file of a 2D texture, aLevels stored as given (already supercompressed if aSupercompression says so)
+static std::vector<uint8_t> makeKTX2(
+	const uint32_t aVkFormat, const uint32_t aWidth, const uint32_t aHeight,
+	const std::vector<std::vector<uint8_t>>& aLevels, const std::vector<uint64_t>& aUncompressedSizes = {},
+	const KTX2Supercompression aSupercompression = KTX2Supercompression::NONE
+) noexcept {
+	static const uint8_t identifier[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+	const uint64_t headerSize = 12 + 9*4 + 4*4 + 2*8;
+	uint64_t dataOffset = headerSize + aLevels.size()*3*8;
+
+	std::vector<uint8_t> file(dataOffset, 0);
+	memcpy(file.data(), identifier, sizeof(identifier));
+	writeU32(file, 12, aVkFormat);
+	writeU32(file, 16, 1); //typeSize
+	writeU32(file, 20, aWidth);
+	writeU32(file, 24, aHeight);
+	writeU32(file, 36, 1); //faces
+	writeU32(file, 40, aLevels.size());
+	writeU32(file, 44, (uint32_t)aSupercompression);
+
+	for(uint64_t i = 0; i < aLevels.size(); i++) {
+		uint64_t entry = headerSize + i*3*8;
+		writeU64(file, entry, file.size());
+		writeU64(file, entry + 8, aLevels[i].size());
+		writeU64(file, entry + 16, i < aUncompressedSizes.size() ? aUncompressedSizes[i] : aLevels[i].size());
+		file.insert(file.end(), aLevels[i].begin(), aLevels[i].end());
+	}
+	return file;
+}
+
+static std::vector<uint8_t> makeLevel(const uint64_t aSize, const uint8_t aSeed) noexcept {
+	std::vector<uint8_t> level(aSize);
+	for(uint64_t i = 0; i < aSize; i++) level[i] = (uint8_t)(aSeed + i*7);
+	return level;
+}
+
+int main() {
+	//RGBA8 mip chain, views point into the file
+	{
+		std::vector<std::vector<uint8_t>> levels = { makeLevel(4*4*4, 1), makeLevel(2*2*4, 2), makeLevel(1*1*4, 3) };
+		std::vector<uint8_t> file = makeKTX2(37, 4, 4, levels);
+		KTX2Image image;
+		bool parsed = parseKTX2(file.data(), file.size(), image);
+		check(parsed && image.format == KTX2Format::RGBA8 && image.levels.size() == 3, "rgba8 parse");
+		for(uint64_t i = 0; parsed && i < levels.size(); i++) {
+			check(image.levels[i].size == levels[i].size() && memcmp(image.levels[i].data, levels[i].data(), levels[i].size()) == 0, "rgba8 level " + std::to_string(i));
+			check(image.levels[i].data >= file.data() && image.levels[i].data < file.data() + file.size(), "rgba8 level " + std::to_string(i) + " is a view");
+		}
+		check(image.inflated.empty() && !image.isCompressed(), "rgba8 not inflated");
+	}
+
+	//block formats round up to whole 4x4 blocks
+	{
+		std::vector<uint8_t> file = makeKTX2(131, 6, 5, { makeLevel(2*2*8, 4) });
+		KTX2Image image;
+		check(parseKTX2(file.data(), file.size(), image) && image.format == KTX2Format::BC1 && image.levels[0].size == 32, "bc1 block rounding");
+		file = makeKTX2(145, 8, 8, { makeLevel(2*2*16, 5), makeLevel(16, 6), makeLevel(16, 7), makeLevel(16, 8) });
+		check(parseKTX2(file.data(), file.size(), image) && image.format == KTX2Format::BC7 && image.levels.size() == 4 && image.getByteSize() == 64+3*16, "bc7 mip chain");
+	}
+
+	//malformed and hostile files
+	{
+		KTX2Image image;
+		std::vector<uint8_t> file = makeKTX2(37, 4, 4, { makeLevel(4*4*4 - 1, 1) });
+		check(!parseKTX2(file.data(), file.size(), image), "short level rejected");
+
+		//offset + size wraps around to a small number
+		file = makeKTX2(37, 1, 1, { makeLevel(4, 1) });
+		writeU64(file, 12 + 9*4 + 4*4 + 2*8, UINT64_MAX - 2);
+		check(!parseKTX2(file.data(), file.size(), image), "wrapping offset rejected");
+		file = makeKTX2(37, 1, 1, { makeLevel(4, 1) });
+		writeU64(file, 12 + 9*4 + 4*4 + 2*8 + 8, UINT64_MAX);
+		check(!parseKTX2(file.data(), file.size(), image), "wrapping size rejected");
+
+		file = makeKTX2(37, 1, 1, { makeLevel(4, 1) });
+		writeU32(file, 40, 20); //level index past the end
+		check(!parseKTX2(file.data(), file.size(), image), "level index out of range rejected");
+
+		file = makeKTX2(37, KTX2_MAX_SIZE*2, 1, { makeLevel(4, 1) });
+		check(!parseKTX2(file.data(), file.size(), image), "oversized image rejected");
+
+		file = makeKTX2(37, 1, 1, { makeLevel(4, 1) });
+		check(!parseKTX2(file.data(), 40, image), "truncated header rejected");
+		file[0] = 0;
+		check(!isKTX2(file.data(), file.size()) && !parseKTX2(file.data(), file.size(), image), "bad identifier rejected");
+	}
+
+	//Basis Universal payloads are not transcoded
+	{
+		KTX2Image image;
+		std::vector<uint8_t> file = makeKTX2(0, 4, 4, { makeLevel(16, 1) });
+		check(!parseKTX2(file.data(), file.size(), image), "uastc rejected");
+		file = makeKTX2(0, 4, 4, { makeLevel(16, 1) }, {}, KTX2Supercompression::BASIS_LZ);
+		check(!parseKTX2(file.data(), file.size(), image), "basislz rejected");
+	}
+
+	//zstd supercompressed levels are decompressed into the image
+	{
+		std::vector<std::vector<uint8_t>> levels = { makeLevel(8*8*4, 9), makeLevel(4*4*4, 10), makeLevel(2*2*4, 11), makeLevel(4, 12) };
+#ifdef GLTF_ZSTD
+		std::vector<std::vector<uint8_t>> compressed;
+		std::vector<uint64_t> sizes;
+		for(const std::vector<uint8_t>& l : levels) {
+			compressed.emplace_back(ZSTD_compressBound(l.size()));
+			compressed.back().resize(ZSTD_compress(compressed.back().data(), compressed.back().size(), l.data(), l.size(), 3));
+			sizes.push_back(l.size());
+		}
+		std::vector<uint8_t> file = makeKTX2(37, 8, 8, compressed, sizes, KTX2Supercompression::ZSTD);
+		KTX2Image image;
+		bool parsed = parseKTX2(file.data(), file.size(), image);
+		check(parsed && image.levels.size() == levels.size() && image.inflated.size() == image.getByteSize(), "zstd parse");
+		for(uint64_t i = 0; parsed && i < levels.size(); i++) {
+			check(image.levels[i].size == levels[i].size() && memcmp(image.levels[i].data, levels[i].data(), levels[i].size()) == 0, "zstd level " + std::to_string(i));
+		}
+
+		//broken frame header, and a level index that lies about the decompressed size
+		file[12 + 9*4 + 4*4 + 2*8 + levels.size()*3*8] ^= 0xFF;
+		check(!parseKTX2(file.data(), file.size(), image) && image.levels.empty(), "corrupt zstd rejected");
+		sizes[0] += 4;
+		file = makeKTX2(37, 8, 8, compressed, sizes, KTX2Supercompression::ZSTD);
+		check(!parseKTX2(file.data(), file.size(), image), "zstd size mismatch rejected");
+#else
+		std::vector<uint8_t> file = makeKTX2(37, 8, 8, levels, {}, KTX2Supercompression::ZSTD);
+		KTX2Image image;
+		check(!parseKTX2(file.data(), file.size(), image), "zstd rejected without zstd");
+#endif
+	}
+
+	std::cout << "KTX2 test: " << sPassed << " passed, " << sFailed << " failed\n";
+	return sFailed == 0 ? 0 : 1;
+}
@@ -1,17 +1,27 @@
 #include "Mesh.hpp"
 
-Mesh::Mesh(std::vector<Vertex>& aVerts, std::vector<GLuint>& aInds, const glm::mat4& aTransform) noexcept {
-	this->mTransform = aTransform;
+//compSkin.glsl reads the VBO as a float array
+static_assert(sizeof(Vertex) == 17*sizeof(float), "Vertex layout changed, update compSkin.glsl");
+//position + normal, vec4 each
+#define SKINNED_VERTEX_SIZE (2*sizeof(glm::vec4))
+#define SKIN_GROUP_SIZE 64
+
+Mesh::Mesh(const MeshData& aData) noexcept {
+	const std::vector<Vertex>& vertices = aData.vertices;
+	const std::vector<uint32_t>& indices = aData.indices;
+	this->mTransform = aData.transform;
+	this->mLODs = aData.lods;
+	if(this->mLODs.empty()) this->mLODs.push_back({ 0, (uint32_t)indices.size(), 0.0f });
 
 	glGenVertexArrays(1, &this->mVAO);
 	glBindVertexArray(this->mVAO);
 
-	this->mVertices = aVerts.size();
-	this->mIndices = aInds.size();
+	this->mVertices = vertices.size();
+	this->mIndices = indices.size();
 
 	glGenBuffers(1, &this->mVBO);
 	glBindBuffer(GL_ARRAY_BUFFER, this->mVBO);
-	glBufferData(GL_ARRAY_BUFFER, aVerts.size()*sizeof(Vertex), aVerts.data(), GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, vertices.size()*sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
 
 	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), (const void*)offsetof(Vertex, position));
 	glEnableVertexAttribArray(0);
@@ -28,15 +38,32 @@ Mesh::Mesh(std::vector<Vertex>& aVerts, std::vector<GLuint>& aInds, const glm::m
 
 	glGenBuffers(1, &this->mIBO);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->mIBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, aInds.size()*sizeof(GLuint), aInds.data(), GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size()*sizeof(GLuint), indices.data(), GL_STATIC_DRAW);
+
+	//every mesh, unskinned ones go through the palette in vertAnim.glsl as well
+	glGenBuffers(1, &this->mSkinnedBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->mSkinnedBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, vertices.size()*SKINNED_VERTEX_SIZE, nullptr, GL_DYNAMIC_COPY);
 }
-void Mesh::draw(const glm::mat4& aProjectionView) noexcept {
+void Mesh::draw(const glm::mat4& aProjectionView, const uint64_t aLOD) noexcept {
+	const MeshLOD& lod = this->mLODs[std::min<uint64_t>(aLOD, this->mLODs.size()-1)];
 	glUniformMatrix4fv(15, 1, GL_FALSE, glm::value_ptr(aProjectionView*this->mTransform));
 
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 53, this->mSkinnedBuffer);
+
 	glBindVertexArray(this->mVAO);
 	glBindBuffer(GL_ARRAY_BUFFER, this->mVBO);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, this->mIBO);
-	glDrawElements(GL_TRIANGLES, this->mIndices, GL_UNSIGNED_INT, nullptr);
+	glDrawElements(GL_TRIANGLES, lod.indexAmount, GL_UNSIGNED_INT, (const void*)(lod.indexOffset*sizeof(GLuint)));
+}
+void Mesh::skin() noexcept {
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 52, this->mVBO);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 53, this->mSkinnedBuffer);
+	glUniform1ui(0, this->mVertices);
+	glDispatchCompute((this->mVertices + SKIN_GROUP_SIZE - 1) / SKIN_GROUP_SIZE, 1, 1);
+}
+uint64_t Mesh::getLODAmount() const noexcept {
+	return this->mLODs.size();
 }
 Mesh::~Mesh() noexcept {
 
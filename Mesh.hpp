@@ -1,32 +1,25 @@
 #ifndef GLTF_MESH
 #define GLTF_MESH
 #include "Texture.hpp"
-
-struct Vertex {
-	glm::vec3 position;
-	glm::vec2 texCoords;
-	glm::vec3 normal;
-	GLfloat materialId;
-
-	glm::vec4 boneIds;
-	glm::vec4 boneWeights;
-};
-
-struct alignas(16) Material {
-	glm::vec4 color = glm::vec4(1.0f);
-	GLfloat textureAmount = 1.0f; //1.0 texture only, 0.0 color only
-	GLint textureSlot = 0;
-	GLfloat textureOpacity = 1.0f;
-};
+#include "ModelData.hpp"
 
 class Mesh {
 public:
-	Mesh(std::vector<Vertex>& aVerts, std::vector<GLuint>& aInds, const glm::mat4& aTransform) noexcept;
-	void draw(const glm::mat4& aProjectionView) noexcept;
+	//GL upload of a MeshData
+	Mesh(const MeshData& aData) noexcept;
+	//aLOD is clamped to the levels we have
+	void draw(const glm::mat4& aProjectionView, const uint64_t aLOD = 0) noexcept;
+	uint64_t getLODAmount() const noexcept;
+
+	//compute skinning (compSkin.glsl bound, palette at binding 51) into our skinned buffer
+	//draw() binds that buffer to 53 for vertSkinned.glsl
+	void skin() noexcept;
 	~Mesh() noexcept;
 private:
 	GLuint mVAO, mVBO, mIBO;
+	GLuint mSkinnedBuffer;
 	uint64_t mVertices, mIndices;
+	std::vector<MeshLOD> mLODs;
 	glm::mat4 mTransform;
 };
 
@@ -1,405 +1,265 @@
 #include "Model.hpp"
 
-Model::Model(const std::filesystem::path& aPath) noexcept {
-	constexpr auto extensions =
-	fastgltf::Extensions::KHR_materials_ior |
-	fastgltf::Extensions::KHR_materials_specular |
-	fastgltf::Extensions::KHR_materials_emissive_strength |
-	fastgltf::Extensions::KHR_materials_sheen
-	;
-
-	auto gdb = fastgltf::GltfDataBuffer::FromPath(aPath);
-	if(!gdb) {
-		std::cerr << "Error: GLTF2 model load failed!\n";
-		return;
+//GL half of texture loading
+static std::shared_ptr<Texture> uploadImage(ImageData& aImage) noexcept {
+	if(!aImage.valid) return nullptr;
+	if(aImage.skipped) return TextureCache::get(aImage.key);
+
+	std::shared_ptr<Texture> result;
+	if(!aImage.ktx.levels.empty()) {
+		Texture texture(aImage.ktx);
+		if(texture.getHandle() != 0) result = TextureCache::insert(aImage.key, std::move(texture));
 	}
-	fastgltf::Parser parse(extensions);
-
-	constexpr auto importOptions =
-	fastgltf::Options::DontRequireValidAssetMember |
-	fastgltf::Options::LoadExternalBuffers |
-	fastgltf::Options::LoadExternalImages |
-	fastgltf::Options::GenerateMeshIndices |
-	fastgltf::Options::DecomposeNodeMatrices
-	;
-
-	//we need to pass directory
-	auto loadState = parse.loadGltfBinary(gdb.get(), aPath.parent_path(), importOptions);
-	fastgltf::Asset* model = loadState.get_if();
-	if(!model) {
-		std::cerr << "Error: GLTF2 model data load failed! " <<
-		fastgltf::getErrorMessage(loadState.error()) <<
-		"(parent path: " <<aPath.parent_path() << ", current: " << aPath << ")\n";
-		return;
+	else {
+		Texture texture(std::move(aImage.pixels));
+		if(texture.getHandle() != 0) result = TextureCache::insert(aImage.key, std::move(texture));
 	}
 
+	//GL has it now
+	aImage.ktx.levels.clear();
+	aImage.ktx.inflated = std::vector<uint8_t>();
+	aImage.ktxBytes = std::vector<std::byte>();
+	return result;
+}
+
+Model::Model(const std::filesystem::path& aPath, JobSystem* aJobs) noexcept {
+	//images some other model already uploaded are not decoded again
+	//the filter holds on to them, so they cannot be released before we take them
+	std::mutex heldMutex;
+	std::vector<std::shared_ptr<Texture>> held;
+	this->mData = ModelData(aPath, [&](const std::string& aKey) {
+		std::shared_ptr<Texture> cached = TextureCache::get(aKey);
+		if(!cached) return false;
+		std::lock_guard<std::mutex> lock(heldMutex);
+		held.push_back(std::move(cached));
+		return true;
+	}, aJobs);
+
+	std::vector<ImageData>& images = this->mData.getImages();
+	std::vector<std::shared_ptr<Texture>> imageTextures(images.size());
+	for(uint64_t i = 0; i < images.size(); i++) imageTextures[i] = uploadImage(images[i]);
+
 	//material
-	uint64_t textureId = 0;
-	for(fastgltf::Material& m : model->materials) {
-		std::cout << "Material: " << m.name.c_str() << '\n';
-
-		this->mMaterials.emplace_back();
-		this->mMaterials.back().color = glm::vec4(1, 0, 1, 1);
-		this->mMaterials.back().color = convertToGLM(m.pbrData.baseColorFactor);
-		this->mMaterials.back().textureAmount = 0.0f;
-		this->mMaterials.back().textureSlot = 0;
-		this->mMaterials.back().textureOpacity = 1.0f;
-
-		auto& texInfo = m.pbrData.baseColorTexture;
-		if(texInfo.has_value()) {
-			this->mMaterials.back().textureAmount = 1.0f;
-			auto& texture = model->textures[texInfo->textureIndex];
-			if(texture.imageIndex.has_value()) {
-				auto& image = model->images[texture.imageIndex.value()];
-				this->mMaterials.back().textureSlot = textureId;
-				textureId++;
-				if(textureId >= 32) {
-					std::cerr << "Error: more than 32 material textures per model are not supported... yet.\n";
-					return;
-				}
-
-				//for each variant possibility - call correct function
-
-				fastgltf::sources::URI* uriData = std::get_if<fastgltf::sources::URI>(&image.data);
-				fastgltf::sources::Array* arrayData = std::get_if<fastgltf::sources::Array>(&image.data);
-				fastgltf::sources::BufferView* bufData = std::get_if<fastgltf::sources::BufferView>(&image.data);
-
-				if(arrayData) {
-					this->mTextures.push_back(Texture(arrayData->bytes.data(), arrayData->bytes.size()));
-				}
-				else if(uriData) {
-					std::cerr << "Error: texture type not supported!\n";
-				}
-				else if(bufData) {
-					//every texture loaded here...
-
-					auto& bufferView = model->bufferViews[bufData->bufferViewIndex];
-					auto& buffer = model->buffers[bufferView.bufferIndex];
-
-					std::visit(fastgltf::visitor {
-						[&](auto& arg) {},
-							   [&](fastgltf::sources::Array& aData) {
-								   this->mTextures.push_back(Texture(aData.bytes.data() + bufferView.byteOffset, bufferView.byteLength));
-							   }
-					}, buffer.data);
-				}
-				else {
-					std::cerr << "Error: texture type undefined!\n";
-				}
-			}
+	this->mMaterials = this->mData.getMaterials();
+	const std::vector<int64_t>& materialImages = this->mData.getMaterialImages();
+	for(uint64_t i = 0; i < this->mMaterials.size(); i++) {
+		if(materialImages[i] < 0) continue;
+
+		int64_t slot = this->getTextureSlot(imageTextures[materialImages[i]]);
+		if(slot >= 0) {
+			this->mMaterials[i].textureAmount = 1.0f;
+			this->mMaterials[i].textureSlot = slot;
+			this->mMaterials[i].textureFlipped = this->mTextures[slot]->isFlipped() ? 1.0f : 0.0f;
 		}
 	}
 
-	std::vector<size_t> meshNodeAccess;
-	meshNodeAccess.resize(model->meshes.size());
+	glGenBuffers(1, &this->mMaterialBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->mMaterialBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, this->mMaterials.size()*sizeof(Material), this->mMaterials.data(), GL_STATIC_DRAW);
 
-	//nodes
-	for(fastgltf::Node& node : model->nodes) {
-		fastgltf::TRS* nt = std::get_if<fastgltf::TRS>(&node.transform);
-		glm::mat4 nodeTransform = glm::scale(glm::mat4(1.0), convertToGLM(nt->scale));
-		nodeTransform *= glm::mat4_cast(convertToGLM(nt->rotation));
-		nodeTransform = glm::translate(nodeTransform, convertToGLM(nt->translation));
+	glGenBuffers(1, &this->mJointMatrixBuffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->mJointMatrixBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, this->mData.getJointAmount()*sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
 
-		if(node.skinIndex.has_value()) {
-			this->mNodes.emplace_back(node.name.c_str(), convertToGLM(fastgltf::getTransformMatrix(node)), nodeTransform, node.skinIndex.value());
-		}
-		else {
-			this->mNodes.emplace_back(node.name.c_str(), convertToGLM(fastgltf::getTransformMatrix(node)), nodeTransform, -1);
-		}
+	glGenBuffers(1, &this->mCrowdJointBuffer);
+	this->mCrowdJointCapacity = 0;
+	glGenBuffers(1, &this->mBakedJointBuffer);
 
-		if(node.meshIndex.has_value()) {
-			this->mNodes.back().meshId = node.meshIndex.value();
-			meshNodeAccess[this->mNodes.back().meshId] = this->mNodes.size()-1;
-		}
+	//meshes
+	for(const MeshData& m : this->mData.getMeshes()) this->mMeshes.emplace_back(m);
 
-		std::cout << node.name.c_str() << ' ' << this->mNodes.size()-1 << ')';
-		for(auto& c : node.children) {
-			std::cout << ' ' << model->nodes[c].name.c_str();
-			this->mNodes.back().children.push_back(c);
-		}
-		std::cout << ' ' << this->mNodes.back().transformMatrix * glm::vec4(1.0) << '\n';
-	};
-
-	//set node parent attribute
-	for(uint64_t i = 0; i < this->mNodes.size(); i++) {
-		for(int64_t c : this->mNodes[i].children) {
-			this->mNodes[c].parent = i; //parent of our children is us
-			std::cout << this->mNodes[c].name << "->" << this->mNodes[i].name << '\n';
-		}
+	this->mData.resetPose(this->mPose);
+}
+
+void Model::draw(const glm::mat4& aProjectionView) noexcept {
+	this->getJointMatrices(this->mJointMatrices);
+	this->draw(aProjectionView, this->mJointMatrices);
+}
+void Model::draw(const glm::mat4& aProjectionView, std::span<const glm::mat4> aJointMatrices, const uint64_t aMeshLOD) noexcept {
+	this->drawMeshes(aProjectionView, aJointMatrices, aMeshLOD, true);
+}
+void Model::skin(Shader& aSkinShader, std::span<const glm::mat4> aJointMatrices) noexcept {
+	this->uploadJointBuffer(aJointMatrices.data(), std::min<uint64_t>(aJointMatrices.size(), this->mData.getJointAmount())*sizeof(glm::mat4));
+	aSkinShader.bind();
+	for(Mesh& m : this->mMeshes) m.skin();
+	//skinned buffers are read as SSBO by the passthrough vertex shader
+	glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
+}
+void Model::drawSkinned(const glm::mat4& aProjectionView, std::span<const glm::mat4> aJointMatrices, const uint64_t aMeshLOD) noexcept {
+	this->drawMeshes(aProjectionView, aJointMatrices, aMeshLOD, false);
+}
+void Model::drawMeshes(const glm::mat4& aProjectionView, std::span<const glm::mat4> aJointMatrices, const uint64_t aMeshLOD, const bool aUploadJoints) noexcept {
+	//cull first - nothing visible, nothing uploaded
+	Frustum frustum(aProjectionView);
+	this->mVisibleMeshes.clear();
+	for(uint64_t i = 0; i < this->mMeshes.size(); i++) {
+		if(frustum.isVisible(this->mData.getMeshBounds(i, aJointMatrices))) this->mVisibleMeshes.push_back(i);
 	}
+	if(this->mVisibleMeshes.empty()) return;
 
-	//process bones
-	for(fastgltf::Skin& s : model->skins) {
-		this->mBones.push_back({});
-		Bone& writeSkin = this->mBones.back();
-		writeSkin.name = s.name.c_str();
+	for(uint64_t i = 0; i < this->mTextures.size(); i++)
+		this->mTextures[i]->bind(i);
 
-		for(size_t j : s.joints) {
-			writeSkin.joints.push_back(j); //joints are nodes!
-		}
+	if(aUploadJoints) this->uploadJoints(aJointMatrices);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 50, this->mMaterialBuffer);
 
-		if(s.inverseBindMatrices.has_value()) {
-			fastgltf::Accessor& ibmAccess =  model->accessors[s.inverseBindMatrices.value()];
-			fastgltf::iterateAccessorWithIndex<fastgltf::math::fmat4x4>(*model, ibmAccess, [&](fastgltf::math::fmat4x4 aV, GLuint aId) {
-				writeSkin.inverseBindMatrix.push_back(convertToGLM(aV));
-			});
+	for(uint64_t i : this->mVisibleMeshes) this->mMeshes[i].draw(aProjectionView, aMeshLOD);
+}
+void Model::draw(const glm::mat4& aProjectionView, const Crowd& aCrowd) noexcept {
+	//visible instances only, compacted - off-screen ones are not uploaded
+	std::vector<uint64_t> visible;
+	aCrowd.getVisible(Frustum(aProjectionView), visible);
+
+	this->mInstanceTransforms.clear();
+	this->mInstanceMeshLODs.clear();
+	this->mInstanceJointMatrices.clear();
+	this->mBakedFrames.clear();
+	this->mBakedTransforms.clear();
+	this->mBakedMeshLODs.clear();
+	bool useBake = aCrowd.getBake() && this->mBakedJointAmount > 0;
+	for(uint64_t id : visible) {
+		const CrowdInstance& instance = aCrowd.getInstances()[id];
+		if(instance.baked && useBake) {
+			this->mBakedFrames.push_back(instance.bakedFrame);
+			this->mBakedTransforms.push_back(instance.transform);
+			this->mBakedMeshLODs.push_back(instance.meshLod);
+			continue;
 		}
+		this->mInstanceTransforms.push_back(instance.transform);
+		this->mInstanceMeshLODs.push_back(instance.meshLod);
+		auto slice = aCrowd.getJointMatrices().begin() + id*aCrowd.getStride();
+		this->mInstanceJointMatrices.insert(this->mInstanceJointMatrices.end(), slice, slice + aCrowd.getStride());
 	}
+	this->drawInstances(aProjectionView, this->mInstanceJointMatrices, aCrowd.getStride(), this->mInstanceTransforms, this->mInstanceMeshLODs);
+	this->drawBaked(aProjectionView, this->mBakedFrames, this->mBakedTransforms, this->mBakedMeshLODs);
+}
+void Model::drawInstances(const glm::mat4& aProjectionView, std::span<const glm::mat4> aJointMatrices, const uint64_t aStride, std::span<const glm::mat4> aTransforms, std::span<const uint8_t> aMeshLODs) noexcept {
+	if(aTransforms.empty()) return;
 
-	//root nodes (children of non-node root)
-	std::cout << "Root nodes ";
-	for(size_t nid : model->scenes[model->defaultScene.value()].nodeIndices) {
-		this->mRootNodes.push_back(nid);
-		std::cout << nid << "\n";
-	}
-	std::cout << std::endl;
+	for(uint64_t i = 0; i < this->mTextures.size(); i++)
+		this->mTextures[i]->bind(i);
 
-	this->getNodeJointAmount();
-	//get offsets for joint matrices (ids bound to node)
-	uint64_t curOff = 0;
-	for(size_t nid : this->mRootNodes) {
-		this->getNodeJointOffset(nid, &curOff);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->mCrowdJointBuffer);
+	if(aJointMatrices.size() > this->mCrowdJointCapacity) {
+		this->mCrowdJointCapacity = aJointMatrices.size();
+		glBufferData(GL_SHADER_STORAGE_BUFFER, aJointMatrices.size()*sizeof(glm::mat4), aJointMatrices.data(), GL_STREAM_DRAW);
 	}
-
-	std::cout << "Joint offsets ";
-	for(Node& n : this->mNodes) std::cout << n.jointsIdOffset << " ";
-	std::cout << std::endl;
-
-	std::cout << "Joint amounts ";
-	for(Node& n : this->mNodes) std::cout << n.amountOfJoints << " ";
-	std::cout << std::endl;
-
-	uint64_t jointMatricesAmount = 0;
-	for(Node& n : this->mNodes) jointMatricesAmount += n.amountOfJoints;
-
-	std::cout << "Total joint amount: " << jointMatricesAmount << '\n';
-	glGenBuffers(1, &this->mJointMatrixBuffer);
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->mJointMatrixBuffer);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, jointMatricesAmount*sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
-	this->mJointsAmount = jointMatricesAmount;
-
-	//meshes
-	uint64_t meshNodeAccessorId = 0;
-	for(fastgltf::Mesh& m : model->meshes) {
-		//aliases
-		std::vector<Vertex> vertices;
-		std::vector<GLuint> indices;
-
-		for(fastgltf::Primitive& p : m.primitives) {
-			size_t initialId = vertices.size();
-			uint64_t matIndex = 32;
-			if(p.materialIndex.has_value()) {
-				matIndex = p.materialIndex.value();
-			}
-
-			//indices
-			{
-				fastgltf::Accessor& indicesAccess = model->accessors[p.indicesAccessor.value()];
-				indices.reserve(indices.size() + indicesAccess.count);
-				fastgltf::iterateAccessor<GLuint>(*model, indicesAccess, [&](GLuint aId) {
-					indices.push_back(aId + initialId);
-				});
-			}
-
-			//position + material index
-			{
-				fastgltf::Accessor& verticesAccess = model->accessors[p.findAttribute("POSITION")->accessorIndex];
-				vertices.resize(vertices.size() + verticesAccess.count);
-				fastgltf::iterateAccessorWithIndex<glm::vec3>(*model, verticesAccess, [&](glm::vec3 aV, GLuint aId) {
-					assert(initialId+aId < vertices.size());
-					vertices[initialId+aId].position = aV;
-					vertices[initialId+aId].materialId = matIndex;
-				});
-			}
-
-			//normals
-			{
-				if(p.findAttribute("NORMAL") != p.attributes.end()) {
-					fastgltf::Accessor& normalAccess = model->accessors[p.findAttribute("NORMAL")->accessorIndex];
-					fastgltf::iterateAccessorWithIndex<glm::vec3>(*model, normalAccess, [&](glm::vec3 aV, GLuint aId) {
-						assert(initialId+aId < vertices.size());
-						vertices[initialId+aId].normal = aV;
-					});
-				}
-			}
-
-			//UVs
-			{
-				if(p.findAttribute("TEXCOORD_0") != p.attributes.end()) {
-					fastgltf::Accessor& uvAccess = model->accessors[p.findAttribute("TEXCOORD_0")->accessorIndex];
-					fastgltf::iterateAccessorWithIndex<glm::vec2>(*model, uvAccess, [&](glm::vec2 aV, GLuint aId) {
-						assert(initialId+aId < vertices.size());
-						vertices[initialId+aId].texCoords.x = aV.x;
-						vertices[initialId+aId].texCoords.y = 1.0 - aV.y; //flipping UVs Y simpler than flipping every image!
-					});
-				}
-			}
-
-			//joints
-			{
-				if(p.findAttribute("JOINTS_0") != p.attributes.end()) {
-					fastgltf::Accessor& jointsAccess = model->accessors[p.findAttribute("JOINTS_0")->accessorIndex];
-					if(p.findAttribute("JOINTS_0") != p.attributes.end()) {
-						fastgltf::iterateAccessorWithIndex<fastgltf::math::u8vec4>(*model, jointsAccess, [&](fastgltf::math::u8vec4 aV, GLuint aId) {
-							vertices[initialId+aId].boneIds[0] = aV.x()+this->mNodes[meshNodeAccess[meshNodeAccessorId]].jointsIdOffset;
-							vertices[initialId+aId].boneIds[1] = aV.y()+this->mNodes[meshNodeAccess[meshNodeAccessorId]].jointsIdOffset;
-							vertices[initialId+aId].boneIds[2] = aV.z()+this->mNodes[meshNodeAccess[meshNodeAccessorId]].jointsIdOffset;
-							vertices[initialId+aId].boneIds[3] = aV.w()+this->mNodes[meshNodeAccess[meshNodeAccessorId]].jointsIdOffset;
-						});
-					}
-				}
-			}
-
-			//weights
-			{
-				if(p.findAttribute("WEIGHTS_0") != p.attributes.end()) {
-					fastgltf::Accessor& jointsAccess = model->accessors[p.findAttribute("WEIGHTS_0")->accessorIndex];
-					if(p.findAttribute("WEIGHTS_0") != p.attributes.end()) {
-						fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec4>(*model, jointsAccess, [&](fastgltf::math::fvec4 aV, GLuint aId) {
-							vertices[initialId+aId].boneWeights[0] = aV.x();
-							vertices[initialId+aId].boneWeights[1] = aV.y();
-							vertices[initialId+aId].boneWeights[2] = aV.z();
-							vertices[initialId+aId].boneWeights[3] = aV.w();
-
-							//sanity check
-							assert(aV.x()+aV.y()+aV.z()+aV.w() > 0.95 || aV.x()+aV.y()+aV.z()+aV.w() == 0.0);
-						});
-					}
-				}
-			}
-		}
-
-		//mesh names are non-descriptive usually, use node names (1 node can only have 1 mesh and vice versa)
-		std::cout << "Mesh name: " << this->mNodes[meshNodeAccess[meshNodeAccessorId]].name << '\n';
-		this->mMeshes.emplace_back(vertices, indices, this->mNodes[meshNodeAccess[meshNodeAccessorId]].transformMatrix);
-		meshNodeAccessorId++;
+	else {
+		glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, aJointMatrices.size()*sizeof(glm::mat4), aJointMatrices.data());
 	}
 
-	glGenBuffers(1, &this->mMaterialBuffer);
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->mMaterialBuffer);
-	glBufferData(GL_SHADER_STORAGE_BUFFER, this->mMaterials.size()*sizeof(Material), this->mMaterials.data(), GL_STATIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 50, this->mMaterialBuffer);
 
-	//process animations
-	for(fastgltf::Animation& a : model->animations) {
-		this->mAnimations.push_back({});
-		auto& anim = this->mAnimations.back();
-		anim.mName = a.name.c_str();
-		std::cout << "Found animation: " << a.name.c_str() << '\n';
-
-		for(fastgltf::AnimationSampler& s : a.samplers) {
-			anim.mSamplers.push_back({});
-
-			fastgltf::Accessor& samplerInputAccess = model->accessors[s.inputAccessor]; //time
-			fastgltf::Accessor& samplerOutputAccess = model->accessors[s.outputAccessor]; //value
-
-			//input - keyframe times
-
-			fastgltf::iterateAccessor<GLfloat>(*model, samplerInputAccess, [&](float aV) {
-				anim.mSamplers.back().time.push_back(aV);
-			});
-
-			//output - property (vec3 for transform, scale - vec4 for rotation quaternion)
-			if(samplerOutputAccess.type == fastgltf::AccessorType::Vec3) {
-				fastgltf::iterateAccessor<glm::vec3>(*model, samplerOutputAccess, [&](glm::vec3 aV) {
-					anim.mSamplers.back().value.push_back(glm::vec4(aV, 1.0));
-				});
-			}
-			else if(samplerOutputAccess.type == fastgltf::AccessorType::Vec4) {
-				fastgltf::iterateAccessor<glm::vec4>(*model, samplerOutputAccess, [&](glm::vec4 aV) {
-					anim.mSamplers.back().value.push_back(aV);
-				});
-			}
-			else {
-				std::cerr << "Wrong type!\n";
-			} //should never happen, GLTF stores "keyframes" only as vec3 or vec4
-		}
-		for(fastgltf::AnimationChannel& c : a.channels) {
-			anim.mSamplers[c.samplerIndex].type = c.path;
-			if(c.nodeIndex.has_value()) {
-				anim.mSamplers[c.samplerIndex].nodeIndex = c.nodeIndex.value();
-			}
-			else {
-				anim.mSamplers[c.samplerIndex].nodeIndex = -1;
-			}
-		}
+	uint64_t sliceSize = std::max<uint64_t>(this->mData.getJointAmount(), 1)*sizeof(glm::mat4);
+	for(uint64_t i = 0; i < aTransforms.size(); i++) {
+		glBindBufferRange(GL_SHADER_STORAGE_BUFFER, 51, this->mCrowdJointBuffer, i*aStride*sizeof(glm::mat4), sliceSize);
+		uint64_t lod = i < aMeshLODs.size() ? aMeshLODs[i] : 0;
+		for(Mesh& m : this->mMeshes) m.draw(aProjectionView * aTransforms[i], lod);
 	}
 }
+void Model::uploadBake(const PaletteBake& aBake) noexcept {
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->mBakedJointBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, aBake.getMemorySize(), aBake.getJointMatrices().data(), GL_STATIC_DRAW);
+	this->mBakedJointAmount = aBake.getFrameAmount() > 0 ? aBake.getJointAmount() : 0;
+}
+void Model::drawBaked(const glm::mat4& aProjectionView, std::span<const uint64_t> aFrames, std::span<const glm::mat4> aTransforms, std::span<const uint8_t> aMeshLODs) noexcept {
+	if(aTransforms.empty() || this->mBakedJointAmount == 0) return;
 
-//id is bound to node -> every node will have offset
-void Model::getNodeJointAmount() {
-	for(uint64_t nodeId = 0; nodeId < this->mNodes.size(); nodeId++) {
-		if (this->mNodes[nodeId].idOfSkin > -1) {
-			Bone      skin             = this->mBones[this->mNodes[nodeId].idOfSkin];
-			size_t    numJoints        = (uint32_t)skin.joints.size();
+	for(uint64_t i = 0; i < this->mTextures.size(); i++)
+		this->mTextures[i]->bind(i);
 
-			this->mNodes[nodeId].amountOfJoints = numJoints;
-		}
+	//the whole bake stays bound, instances only move the offset
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 50, this->mMaterialBuffer);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 51, this->mBakedJointBuffer);
+	for(uint64_t i = 0; i < aTransforms.size(); i++) {
+		glUniform1ui(14, aFrames[i]*this->mBakedJointAmount);
+		uint64_t lod = i < aMeshLODs.size() ? aMeshLODs[i] : 0;
+		for(Mesh& m : this->mMeshes) m.draw(aProjectionView * aTransforms[i], lod);
 	}
+	glUniform1ui(14, 0);
+}
+void Model::setStateAtTime(uint64_t aId, float aTime) noexcept {
+	this->mData.setStateAtTime(this->mPose, aId, aTime);
 }
 
-//same structure as updateJoints
-void Model::getNodeJointOffset(uint64_t aId, uint64_t* aCurrentOffset) {
-	this->mNodes[aId].jointsIdOffset = *aCurrentOffset;
-	*aCurrentOffset += this->mNodes[aId].amountOfJoints;
+void Model::setSkinningMode(const SkinningMode aMode) noexcept {
+	this->mSkinningMode = aMode;
+}
+SkinningMode Model::getSkinningMode() const noexcept {
+	return this->mSkinningMode;
+}
 
-	for(auto& child : this->mNodes[aId].children) this->getNodeJointOffset(child, aCurrentOffset);
+void Model::getJointMatrices(std::vector<glm::mat4>& aJointMatrices) noexcept {
+	this->mData.getJointMatrices(this->mPose, aJointMatrices);
 }
 
-//https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html
-//https://www.khronos.org/files/gltf20-reference-guide.pdf
-//https://github.com/SaschaWillems/Vulkan/blob/master/examples/gltfskinning/README.md
-//https://github.com/SaschaWillems/Vulkan/blob/master/examples/gltfskinning/gltfskinning.cpp
-
-glm::mat4 Model::getNodeMatrix(Node& node) {
-	glm::mat4 nodeMatrix = node.localMatrix;
-	int64_t currentParent = node.parent;
-	while (currentParent != -1) {
-		nodeMatrix = this->mNodes[currentParent].localMatrix * nodeMatrix;
-		currentParent = this->mNodes[currentParent].parent;
-	}
-	return nodeMatrix;
+uint64_t Model::getAnimationAmount() const noexcept {
+	return this->mData.getAnimationAmount();
+}
+uint64_t Model::getJointAmount() const noexcept {
+	return this->mData.getJointAmount();
 }
 
-void Model::updateJoints(Node& node, std::vector<glm::mat4>& aJointMatrices) {
-	if (node.idOfSkin > -1) {
-		glm::mat4              inverseTransform = glm::inverse(node.transformMatrix);
-		Bone                   skin             = this->mBones[node.idOfSkin];
-		size_t                 numJoints        = (uint32_t)skin.joints.size();
-		std::vector<glm::mat4> jointMatrices(numJoints);
-		for (size_t i = 0; i < numJoints; i++) {
-			//do NOT set transform matrix anew
-			jointMatrices[i] = getNodeMatrix(this->mNodes[skin.joints[i]]) * skin.inverseBindMatrix[i];
-			jointMatrices[i] = inverseTransform * jointMatrices[i];
-		}
+uint64_t Model::getMeshLODAmount() const noexcept {
+	uint64_t amount = 1;
+	for(const Mesh& m : this->mMeshes) amount = std::max(amount, m.getLODAmount());
+	return amount;
+}
 
-		aJointMatrices.insert(aJointMatrices.end(), jointMatrices.begin(), jointMatrices.end());
-	}
+const ModelData& Model::getData() const noexcept {
+	return this->mData;
+}
+Pose& Model::getPose() noexcept {
+	return this->mPose;
+}
 
-	for(auto& child : node.children) updateJoints(this->mNodes[child], aJointMatrices);
+uint64_t Model::getJointStrideAlignment() noexcept {
+	GLint alignment = 1;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	return std::max<uint64_t>((alignment + sizeof(glm::mat4) - 1) / sizeof(glm::mat4), 1);
 }
 
-void Model::draw(const glm::mat4& aProjectionView) noexcept {
-	for(uint64_t i = 0; i < this->mTextures.size(); i++)
-		this->mTextures[i].bind(i);
+Model::~Model() noexcept {}
 
-	std::vector<glm::mat4> jointMatrices;
-	for(size_t id : this->mRootNodes) {
-		this->updateJoints(this->mNodes[id], jointMatrices);
+void Model::uploadJoints(std::span<const glm::mat4> aJointMatrices) noexcept {
+	uint64_t amount = std::min<uint64_t>(aJointMatrices.size(), this->mData.getJointAmount());
+	if(this->mSkinningMode == SkinningMode::MATRIX) {
+		this->uploadJointBuffer(aJointMatrices.data(), amount*sizeof(glm::mat4));
+		return;
 	}
 
-	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->mJointMatrixBuffer);
-	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, jointMatrices.size()*sizeof(glm::mat4), jointMatrices.data());
+	if(this->mSkinningMode == SkinningMode::AFFINE) {
+		this->mAffineMatrices.resize(amount);
+		for(uint64_t i = 0; i < amount; i++) this->mAffineMatrices[i] = getAffineMatrix(aJointMatrices[i]);
+		this->uploadJointBuffer(this->mAffineMatrices.data(), amount*sizeof(AffineMatrix));
+		return;
+	}
 
+	this->mDualQuaternions.resize(amount);
+	if(!getDualQuaternions(aJointMatrices.first(amount), this->mDualQuaternions) && !this->mScaleWarned) {
+		std::cerr << "Warning: model has scaled joints, dual quaternion skinning ignores the scale - use matrix skinning.\n";
+		this->mScaleWarned = true;
+	}
+	this->uploadJointBuffer(this->mDualQuaternions.data(), amount*sizeof(DualQuaternion));
+}
+void Model::uploadJointBuffer(const void* aData, const uint64_t aSize) noexcept {
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, this->mJointMatrixBuffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, 0, aSize, aData);
 	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 51, this->mJointMatrixBuffer);
-	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 50, this->mMaterialBuffer);
-
-	for(Mesh& m : this->mMeshes) m.draw(aProjectionView);
 }
 
-void Model::setStateAtTime(uint64_t aId, float aTime) noexcept {
-	 this->mAnimations[aId].setStateAtTime(*this, aTime);
-}
-uint64_t Model::getAnimationAmount() const noexcept {
-	return this->mAnimations.size();
+//materials sharing a texture (same image or same content) share the slot
+int64_t Model::getTextureSlot(const std::shared_ptr<Texture>& aTexture) noexcept {
+	if(!aTexture) return -1;
+
+	for(uint64_t i = 0; i < this->mTextures.size(); i++) {
+		if(this->mTextures[i] == aTexture) return i;
+	}
+
+	if(this->mTextures.size() >= 32) {
+		std::cerr << "Error: more than 32 material textures per model are not supported... yet.\n";
+		return -1;
+	}
+	this->mTextures.push_back(aTexture);
+	return this->mTextures.size()-1;
 }
-Model::~Model() noexcept {}
@@ -1,66 +1,96 @@
 #ifndef GLTF_MODELLOAD
 #define GLTF_MODELLOAD
 #include "Mesh.hpp"
-#include "Animation.hpp"
+#include "Crowd.hpp"
+#include "Skinning.hpp"
 
-struct Node {
-	std::string name;
-	glm::mat4 originalLocalMatrix;
-	glm::mat4 localMatrix;
-	glm::mat4 transformMatrix;
-	int64_t idOfSkin;
-	int64_t meshId;
-
-	std::vector<uint64_t> children;
-	int64_t parent = -1;
-
-	uint64_t amountOfJoints = 0;
-	uint64_t jointsIdOffset = 0;
-
-	Node() noexcept {};
-	Node(const std::string& aName, const glm::mat4& aGlobal, const glm::mat4& aLocal, const int64_t aIdOfSkin) noexcept
-	: name(aName), transformMatrix(aGlobal), originalLocalMatrix(aLocal), localMatrix(aLocal), idOfSkin(aIdOfSkin) {};
-	~Node() noexcept {};
-};
-
-struct Bone {
-	std::string name;
-	std::vector<uint64_t> joints;
-	std::vector<glm::mat4> inverseBindMatrix;
+enum class SkinningMode : uint8_t {
+	MATRIX = 0, //vertAnim.glsl, handles any scale
+	AFFINE, //vertAnimAffine.glsl, 3x4 - same result, 25% less palette data
+	DUAL_QUATERNION //vertAnimDQ.glsl, half the palette size and no candy-wrapping, rigid joints only
 };
 
+//GL side of a model - uploads what ModelData loaded, keeps one Pose for the viewer
 class Model {
-	friend class Animation;
 public:
-	Model(const std::filesystem::path& aPath) noexcept;
+	//aJobs decodes images and builds mesh LODs in parallel (nullptr = calling thread only)
+	Model(const std::filesystem::path& aPath, JobSystem* aJobs = nullptr) noexcept;
 
 	void draw(const glm::mat4& aProjectionView) noexcept;
+	//palette evaluated elsewhere (e.g. by the simulation thread)
+	//meshes outside the frustum (skinned bounds) are skipped, the palette is not uploaded if all are
+	void draw(const glm::mat4& aProjectionView, std::span<const glm::mat4> aJointMatrices, const uint64_t aMeshLOD = 0) noexcept;
+	//compute skinning: skins every mesh once into its skinned buffer, any number of passes can then
+	//drawSkinned() with vertSkinned.glsl without skinning again
+	void skin(Shader& aSkinShader, std::span<const glm::mat4> aJointMatrices) noexcept;
+	//meshes as the last skin() left them - aJointMatrices only culls, the palette is not uploaded again
+	void drawSkinned(const glm::mat4& aProjectionView, std::span<const glm::mat4> aJointMatrices, const uint64_t aMeshLOD = 0) noexcept;
+
+	//one upload of the visible part of the crowd palette buffer, binding 51 moved to each instance slice
+	//baked instances are drawn from the uploaded bake (uploadBake)
+	void draw(const glm::mat4& aProjectionView, const Crowd& aCrowd) noexcept;
+	//no culling, aJointMatrices holds exactly the slices of aTransforms, aMeshLODs one level per instance (or empty)
+	void drawInstances(const glm::mat4& aProjectionView, std::span<const glm::mat4> aJointMatrices, const uint64_t aStride, std::span<const glm::mat4> aTransforms, std::span<const uint8_t> aMeshLODs = {}) noexcept;
+	//baked palettes to the GPU, replaces the previous bake - call again if the bake changes
+	void uploadBake(const PaletteBake& aBake) noexcept;
+	//baked instances (vertAnim.glsl), one frame per instance from PaletteBake::getFrame - no palette upload per frame
+	void drawBaked(const glm::mat4& aProjectionView, std::span<const uint64_t> aFrames, std::span<const glm::mat4> aTransforms, std::span<const uint8_t> aMeshLODs = {}) noexcept;
 	void setStateAtTime(uint64_t aId, float aTime) noexcept;
 
+	//palette format draw(aProjectionView, aJointMatrices) uploads, bind the matching shader
+	//crowds and compute skinning always use matrices
+	void setSkinningMode(const SkinningMode aMode) noexcept;
+	SkinningMode getSkinningMode() const noexcept;
+
+	//skinning palette of current state, what draw() uploads to binding 51
+	void getJointMatrices(std::vector<glm::mat4>& aJointMatrices) noexcept;
+
 	uint64_t getAnimationAmount() const noexcept;
+	uint64_t getJointAmount() const noexcept;
+	uint64_t getMeshLODAmount() const noexcept; //of the most detailed mesh
+
+	const ModelData& getData() const noexcept;
+	Pose& getPose() noexcept;
+
+	//Crowd stride alignment for this GL implementation, in matrices
+	static uint64_t getJointStrideAlignment() noexcept;
 
 	~Model() noexcept;
 private:
-	std::vector<uint64_t> mRootNodes;
+	ModelData mData;
+	Pose mPose;
+	std::vector<glm::mat4> mJointMatrices;
+	std::vector<glm::mat4> mInstanceTransforms;
+	std::vector<glm::mat4> mInstanceJointMatrices;
+	std::vector<uint8_t> mInstanceMeshLODs;
+	std::vector<uint64_t> mBakedFrames;
+	std::vector<glm::mat4> mBakedTransforms;
+	std::vector<uint8_t> mBakedMeshLODs;
+	std::vector<uint64_t> mVisibleMeshes;
+	SkinningMode mSkinningMode = SkinningMode::MATRIX;
+	std::vector<DualQuaternion> mDualQuaternions;
+	std::vector<AffineMatrix> mAffineMatrices;
+	bool mScaleWarned = false; //dual quaternions dropped scale, said so once
 
 	std::vector<Mesh> mMeshes;
-	std::vector<Node> mNodes;
-	std::vector<Bone> mBones;
-	std::vector<Material> mMaterials;
-	std::vector<Texture> mTextures;
-	std::vector<Animation> mAnimations;
+	std::vector<Material> mMaterials; //texture slots filled in, ModelData only has the images
+	std::vector<std::shared_ptr<Texture>> mTextures; //shared through TextureCache, index = material texture slot
 
 	GLuint mMaterialBuffer;
 	GLuint mJointMatrixBuffer;
-	size_t mJointsAmount;
+	GLuint mCrowdJointBuffer;
+	uint64_t mCrowdJointCapacity; //in matrices
+	GLuint mBakedJointBuffer;
+	uint64_t mBakedJointAmount = 0; //matrices per baked frame, 0 = nothing uploaded
 
-	//workaround: joint ID bound to node, we want to store in array
-	//get order of node, add offset
-	void getNodeJointAmount();
-	void getNodeJointOffset(uint64_t aId, uint64_t* aCurrentOffset); //call AFTER getting amount
+	//culls, binds textures and materials, uploads the palette if aUploadJoints
+	void drawMeshes(const glm::mat4& aProjectionView, std::span<const glm::mat4> aJointMatrices, const uint64_t aMeshLOD, const bool aUploadJoints) noexcept;
+	//packed to mSkinningMode's palette format, the matrices are still needed for culling and compute skinning
+	void uploadJoints(std::span<const glm::mat4> aJointMatrices) noexcept;
+	void uploadJointBuffer(const void* aData, const uint64_t aSize) noexcept;
 
-	glm::mat4 getNodeMatrix(Node& node);
-	void updateJoints(Node& node, std::vector<glm::mat4>& aJointMatrices);
+	//adds texture to mTextures if not there yet, returns its slot (-1 on failure)
+	int64_t getTextureSlot(const std::shared_ptr<Texture>& aTexture) noexcept;
 };
 
 #endif
@@ -0,0 +1,862 @@
+#include "ModelData.hpp"
+#include "Simplify.hpp"
+#include "JobSystem.hpp"
+
+#ifdef FASTGLTF_HAS_MEMORY_MAPPED_FILE
+using ImageFile = fastgltf::MappedGltfFile;
+#else
+using ImageFile = fastgltf::GltfDataBuffer;
+#endif
+
+//triangle ratio of each mesh LOD to the full mesh, and the screen coverage below which it is used
+static const std::array<float, 3> MeshLODRatios = { 0.5f, 0.25f, 0.125f };
+static const std::array<float, 3> MeshLODCoverage = { 0.15f, 0.06f, 0.02f };
+
+//each level simplified from the previous one, appended to the same index list
+static void getMeshLODs(MeshData& aMesh) noexcept {
+	uint32_t fullAmount = aMesh.indices.size();
+	aMesh.lods.push_back({ 0, fullAmount, 0.0f });
+
+	for(float ratio : MeshLODRatios) {
+		const MeshLOD& previous = aMesh.lods.back();
+		uint64_t target = (uint64_t)(fullAmount/3 * ratio) * 3;
+		if(target < 3*16) break; //not worth another level
+
+		float error;
+		std::vector<uint32_t> indices = simplifyMesh(aMesh.vertices, std::span<const uint32_t>(aMesh.indices).subspan(previous.indexOffset, previous.indexAmount), target, error);
+		if(indices.size() > previous.indexAmount * 9 / 10) break; //locked up, more levels would only repeat this one
+
+		MeshLOD lod = { (uint32_t)aMesh.indices.size(), (uint32_t)indices.size(), error };
+		aMesh.indices.insert(aMesh.indices.end(), indices.begin(), indices.end());
+		aMesh.lods.push_back(lod);
+	}
+}
+
+//min/max are optional in glTF, but required for POSITION
+static bool getAccessorBounds(const fastgltf::Accessor& aAccessor, BoundingBox& aBox) noexcept {
+	const auto* min = std::get_if<FASTGLTF_STD_PMR_NS::vector<double>>(&aAccessor.min);
+	const auto* max = std::get_if<FASTGLTF_STD_PMR_NS::vector<double>>(&aAccessor.max);
+	if(!min || !max || min->size() < 3 || max->size() < 3) return false;
+	aBox.extend(glm::vec3((*min)[0], (*min)[1], (*min)[2]));
+	aBox.extend(glm::vec3((*max)[0], (*max)[1], (*max)[2]));
+	return true;
+}
+
+//one sphere per joint around the vertices it has any weight on
+static void getJointBounds(MeshData& aMesh) noexcept {
+	std::unordered_map<uint32_t, BoundingBox> boxes;
+	for(const Vertex& v : aMesh.vertices) {
+		for(int k = 0; k < 4; k++) {
+			if(v.boneWeights[k] > 0.0f) boxes[(uint32_t)v.boneIds[k]].extend(v.position);
+		}
+	}
+
+	std::unordered_map<uint32_t, uint64_t> ids;
+	for(auto& [joint, box] : boxes) {
+		ids[joint] = aMesh.jointBounds.size();
+		aMesh.jointBounds.push_back({ joint, { (box.min + box.max)*0.5f, 0.0f } });
+	}
+	for(const Vertex& v : aMesh.vertices) {
+		for(int k = 0; k < 4; k++) {
+			if(v.boneWeights[k] <= 0.0f) continue;
+			BoundingSphere& sphere = aMesh.jointBounds[ids[(uint32_t)v.boneIds[k]]].sphere;
+			sphere.radius = std::max(sphere.radius, glm::distance(sphere.center, v.position));
+		}
+	}
+	std::sort(aMesh.jointBounds.begin(), aMesh.jointBounds.end(), [](const JointBounds& aA, const JointBounds& aB) { return aA.joint < aB.joint; });
+}
+
+//finds the encoded bytes of an image (embedded, data URI or external file) and decodes them
+//thread safe - no GL calls
+static void decodeImage(fastgltf::Asset& aAsset, const std::filesystem::path& aDirectory, const uint64_t aImageIndex, ImageData& aImage, const ImageFilter& aImageFilter) noexcept {
+	fastgltf::Image& image = aAsset.images[aImageIndex];
+	const std::byte* data = nullptr;
+	size_t size = 0;
+
+	//only needed until decoded
+	std::unique_ptr<ImageFile> file; //external image, mapped if possible
+	fastgltf::StaticVector<std::uint8_t> dataUri(0);
+
+	std::visit(fastgltf::visitor {
+		[&](auto& arg) {},
+		[&](fastgltf::sources::Array& aData) {
+			data = aData.bytes.data();
+			size = aData.bytes.size();
+		},
+		[&](fastgltf::sources::Vector& aData) {
+			data = aData.bytes.data();
+			size = aData.bytes.size();
+		},
+		[&](fastgltf::sources::BufferView& aView) {
+			auto& bufferView = aAsset.bufferViews[aView.bufferViewIndex];
+			auto& buffer = aAsset.buffers[bufferView.bufferIndex];
+
+			std::visit(fastgltf::visitor {
+				[&](auto& arg) {},
+				[&](fastgltf::sources::Array& aData) {
+					data = aData.bytes.data() + bufferView.byteOffset;
+					size = bufferView.byteLength;
+				},
+				[&](fastgltf::sources::Vector& aData) {
+					data = aData.bytes.data() + bufferView.byteOffset;
+					size = bufferView.byteLength;
+				}
+			}, buffer.data);
+		},
+		[&](fastgltf::sources::URI& aUri) {
+			if(aUri.uri.isDataUri()) {
+				//fastgltf decodes the ones in the JSON itself, this catches any it leaves to us
+				std::string_view path = aUri.uri.path();
+				dataUri = fastgltf::base64::decode(path.substr(path.find(',') + 1));
+				data = (const std::byte*)dataUri.data();
+				size = dataUri.size();
+			}
+			else if(aUri.uri.isLocalPath()) {
+				std::filesystem::path path = aDirectory / aUri.uri.fspath();
+				std::error_code error;
+				std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+				aImage.key = "file:" + (error ? path : canonical).string();
+
+				//skip reading the file at all if we have it
+				aImage.skipped = aImageFilter && aImageFilter(aImage.key);
+				if(aImage.skipped) return;
+
+				auto mapped = ImageFile::FromPath(path);
+				if(!mapped) {
+					std::cerr << "Error: failed to open image " << path << "!\n";
+					return;
+				}
+				file = std::make_unique<ImageFile>(std::move(mapped.get()));
+				fastgltf::span<std::byte> bytes(*file);
+				if(aUri.fileByteOffset >= bytes.size()) return;
+				data = bytes.data() + aUri.fileByteOffset;
+				size = bytes.size() - aUri.fileByteOffset;
+			}
+			else {
+				std::cerr << "Error: remote image URIs are not supported! (" << aUri.uri.string() << ")\n";
+			}
+		}
+	}, image.data);
+
+	if(aImage.skipped) {
+		aImage.valid = true;
+		return;
+	}
+	if(!data) {
+		std::cerr << "Error: texture type undefined!\n";
+		return;
+	}
+
+	if(aImage.key.empty()) aImage.key = getImageKey(data, size);
+	aImage.skipped = aImageFilter && aImageFilter(aImage.key);
+	if(aImage.skipped) {
+		aImage.valid = true;
+		return;
+	}
+
+	if(isKTX2(data, size)) {
+		//the source (file mapping, asset buffer) does not outlive loading, keep our own copy for upload
+		aImage.ktxBytes.assign(data, data + size);
+		aImage.valid = parseKTX2(aImage.ktxBytes.data(), aImage.ktxBytes.size(), aImage.ktx);
+		if(!aImage.ktx.inflated.empty()) aImage.ktxBytes = std::vector<std::byte>(); //levels were decompressed, the file is not needed
+	}
+	else {
+		aImage.pixels = TextureData(data, size);
+		aImage.valid = aImage.pixels.pixels != nullptr;
+	}
+}
+
+
+AffineMatrix getAffineMatrix(const glm::mat4& aMatrix) noexcept {
+	//glm is column major, row r is element r of every column
+	AffineMatrix result;
+	for(uint64_t r = 0; r < 3; r++) result.rows[r] = glm::vec4(aMatrix[0][r], aMatrix[1][r], aMatrix[2][r], aMatrix[3][r]);
+	return result;
+}
+
+glm::vec3 RootMotion::getDisplacement(const float aTime) const noexcept {
+	if(this->time.empty() || aTime <= this->time.front()) return glm::vec3(0.0f);
+	if(aTime >= this->time.back()) return this->loopDelta;
+	uint64_t next = std::upper_bound(this->time.begin(), this->time.end(), aTime) - this->time.begin();
+	float factor = (aTime - this->time[next-1]) / (this->time[next] - this->time[next-1]);
+	return glm::mix(this->displacement[next-1], this->displacement[next], factor);
+}
+
+ModelData::ModelData() noexcept {}
+ModelData::ModelData(const std::filesystem::path& aPath, const ImageFilter& aImageFilter, JobSystem* aJobs) noexcept {
+	constexpr auto extensions =
+	fastgltf::Extensions::KHR_materials_ior |
+	fastgltf::Extensions::KHR_materials_specular |
+	fastgltf::Extensions::KHR_materials_emissive_strength |
+	fastgltf::Extensions::KHR_materials_sheen |
+	fastgltf::Extensions::KHR_texture_basisu
+	;
+
+	auto gdb = fastgltf::GltfDataBuffer::FromPath(aPath);
+	if(!gdb) {
+		std::cerr << "Error: GLTF2 model load failed!\n";
+		return;
+	}
+	fastgltf::Parser parse(extensions);
+
+	constexpr auto importOptions =
+	fastgltf::Options::DontRequireValidAssetMember |
+	fastgltf::Options::LoadExternalBuffers | //external images are mapped and decoded by us, in parallel
+	fastgltf::Options::GenerateMeshIndices |
+	fastgltf::Options::DecomposeNodeMatrices
+	;
+
+	//we need to pass directory, .gltf and .glb both accepted
+	auto loadState = parse.loadGltf(gdb.get(), aPath.parent_path(), importOptions);
+	fastgltf::Asset* model = loadState.get_if();
+	if(!model) {
+		std::cerr << "Error: GLTF2 model data load failed! " <<
+		fastgltf::getErrorMessage(loadState.error()) <<
+		"(parent path: " <<aPath.parent_path() << ", current: " << aPath << ")\n";
+		return;
+	}
+
+	//images - reading and decoding runs on worker threads, uploading is up to the GL layer
+	this->mImages.resize(model->images.size());
+
+	//regular image first - KHR_texture_basisu sources hold Basis Universal data we cannot transcode,
+	//they are only tried when there is nothing else (precompressed KTX2 in there still loads)
+	std::vector<uint64_t> imageIndices;
+	for(fastgltf::Texture& t : model->textures) {
+		if(t.imageIndex.has_value()) imageIndices.push_back(t.imageIndex.value());
+		else if(t.basisuImageIndex.has_value()) imageIndices.push_back(t.basisuImageIndex.value());
+	}
+	this->loadImages(*model, aPath.parent_path(), imageIndices, aImageFilter, aJobs);
+
+	//material
+	for(fastgltf::Material& m : model->materials) {
+		std::cout << "Material: " << m.name.c_str() << '\n';
+
+		this->mMaterials.emplace_back();
+		this->mMaterials.back().color = convertToGLM(m.pbrData.baseColorFactor);
+		this->mMaterials.back().textureAmount = 0.0f; //set by the GL layer once the texture is uploaded
+		this->mMaterials.back().textureSlot = 0;
+		this->mMaterials.back().textureOpacity = 1.0f;
+		this->mMaterialImages.push_back(-1);
+
+		auto& texInfo = m.pbrData.baseColorTexture;
+		if(texInfo.has_value()) {
+			auto& texture = model->textures[texInfo->textureIndex];
+
+			if(texture.imageIndex.has_value() && this->mImages[texture.imageIndex.value()].valid) {
+				this->mMaterialImages.back() = texture.imageIndex.value();
+			}
+			else if(texture.basisuImageIndex.has_value() && this->mImages[texture.basisuImageIndex.value()].valid) {
+				this->mMaterialImages.back() = texture.basisuImageIndex.value();
+			}
+		}
+	}
+
+	std::vector<size_t> meshNodeAccess;
+	meshNodeAccess.resize(model->meshes.size());
+
+	//nodes
+	for(fastgltf::Node& node : model->nodes) {
+		//DecomposeNodeMatrices - always TRS
+		fastgltf::TRS* nt = std::get_if<fastgltf::TRS>(&node.transform);
+		glm::vec3 translation = convertToGLM(nt->translation);
+		glm::quat rotation = convertToGLM(nt->rotation);
+		glm::vec3 scale = convertToGLM(nt->scale);
+		glm::mat4 nodeTransform = glm::translate(glm::mat4(1.0), translation) * glm::mat4_cast(rotation) * glm::scale(glm::mat4(1.0), scale);
+
+		if(node.skinIndex.has_value()) {
+			this->mNodes.emplace_back(node.name.c_str(), convertToGLM(fastgltf::getTransformMatrix(node)), nodeTransform, node.skinIndex.value());
+		}
+		else {
+			this->mNodes.emplace_back(node.name.c_str(), convertToGLM(fastgltf::getTransformMatrix(node)), nodeTransform, -1);
+		}
+		this->mNodes.back().translation = translation;
+		this->mNodes.back().rotation = rotation;
+		this->mNodes.back().scale = scale;
+
+		if(node.meshIndex.has_value()) {
+			this->mNodes.back().meshId = node.meshIndex.value();
+			meshNodeAccess[this->mNodes.back().meshId] = this->mNodes.size()-1;
+		}
+
+		std::cout << node.name.c_str() << ' ' << this->mNodes.size()-1 << ')';
+		for(auto& c : node.children) {
+			std::cout << ' ' << model->nodes[c].name.c_str();
+			this->mNodes.back().children.push_back(c);
+		}
+		std::cout << ' ' << this->mNodes.back().transformMatrix * glm::vec4(1.0) << '\n';
+	};
+
+	//set node parent attribute
+	for(uint64_t i = 0; i < this->mNodes.size(); i++) {
+		for(int64_t c : this->mNodes[i].children) {
+			this->mNodes[c].parent = i; //parent of our children is us
+			std::cout << this->mNodes[c].name << "->" << this->mNodes[i].name << '\n';
+		}
+	}
+
+	//process bones
+	for(fastgltf::Skin& s : model->skins) {
+		this->mBones.push_back({});
+		Bone& writeSkin = this->mBones.back();
+		writeSkin.name = s.name.c_str();
+
+		for(size_t j : s.joints) {
+			writeSkin.joints.push_back(j); //joints are nodes!
+		}
+
+		if(s.inverseBindMatrices.has_value()) {
+			fastgltf::Accessor& ibmAccess =  model->accessors[s.inverseBindMatrices.value()];
+			fastgltf::iterateAccessorWithIndex<fastgltf::math::fmat4x4>(*model, ibmAccess, [&](fastgltf::math::fmat4x4 aV, uint32_t aId) {
+				writeSkin.inverseBindMatrix.push_back(convertToGLM(aV));
+			});
+		}
+		//missing inverse bind matrices are identity (spec)
+		writeSkin.inverseBindMatrix.resize(writeSkin.joints.size(), glm::mat4(1.0f));
+	}
+
+	//root nodes (children of non-node root)
+	std::cout << "Root nodes ";
+	if(!model->scenes.empty()) {
+		for(size_t nid : model->scenes[model->defaultScene.value_or(0)].nodeIndices) {
+			this->mRootNodes.push_back(nid);
+			std::cout << nid << "\n";
+		}
+	}
+	std::cout << std::endl;
+
+	//parents before children - nodes outside the scene are evaluated too, animations may still target them
+	for(uint64_t i = 0; i < this->mNodes.size(); i++) {
+		if(this->mNodes[i].parent == -1) this->getEvaluationOrder(i);
+	}
+
+	this->getNodeJointAmount();
+	//get offsets for joint matrices (ids bound to node)
+	uint64_t curOff = 0;
+	for(size_t nid : this->mRootNodes) {
+		this->getNodeJointOffset(nid, &curOff);
+	}
+
+	std::cout << "Joint offsets ";
+	for(Node& n : this->mNodes) std::cout << n.jointsIdOffset << " ";
+	std::cout << std::endl;
+
+	std::cout << "Joint amounts ";
+	for(Node& n : this->mNodes) std::cout << n.amountOfJoints << " ";
+	std::cout << std::endl;
+
+	this->mJointsAmount = curOff;
+	this->getJointLevels();
+	std::cout << "Total joint amount: " << this->mJointsAmount << '\n';
+
+	//meshes
+	uint64_t meshNodeAccessorId = 0;
+	for(fastgltf::Mesh& m : model->meshes) {
+		this->mMeshes.emplace_back();
+		std::vector<Vertex>& vertices = this->mMeshes.back().vertices;
+		std::vector<uint32_t>& indices = this->mMeshes.back().indices;
+		Node& meshNode = this->mNodes[meshNodeAccess[meshNodeAccessorId]];
+
+		for(fastgltf::Primitive& p : m.primitives) {
+			size_t initialId = vertices.size();
+			uint64_t matIndex = 32;
+			if(p.materialIndex.has_value()) {
+				matIndex = p.materialIndex.value();
+			}
+
+			//indices
+			{
+				fastgltf::Accessor& indicesAccess = model->accessors[p.indicesAccessor.value()];
+				indices.reserve(indices.size() + indicesAccess.count);
+				fastgltf::iterateAccessor<uint32_t>(*model, indicesAccess, [&](uint32_t aId) {
+					indices.push_back(aId + initialId);
+				});
+			}
+
+			//position + material index
+			{
+				fastgltf::Accessor& verticesAccess = model->accessors[p.findAttribute("POSITION")->accessorIndex];
+				if(!getAccessorBounds(verticesAccess, this->mMeshes.back().bounds)) {
+					fastgltf::iterateAccessor<glm::vec3>(*model, verticesAccess, [&](glm::vec3 aV) {
+						this->mMeshes.back().bounds.extend(aV);
+					});
+				}
+				vertices.resize(vertices.size() + verticesAccess.count);
+				fastgltf::iterateAccessorWithIndex<glm::vec3>(*model, verticesAccess, [&](glm::vec3 aV, uint32_t aId) {
+					assert(initialId+aId < vertices.size());
+					vertices[initialId+aId].position = aV;
+					vertices[initialId+aId].materialId = matIndex;
+				});
+			}
+
+			//normals
+			{
+				if(p.findAttribute("NORMAL") != p.attributes.end()) {
+					fastgltf::Accessor& normalAccess = model->accessors[p.findAttribute("NORMAL")->accessorIndex];
+					fastgltf::iterateAccessorWithIndex<glm::vec3>(*model, normalAccess, [&](glm::vec3 aV, uint32_t aId) {
+						assert(initialId+aId < vertices.size());
+						vertices[initialId+aId].normal = aV;
+					});
+				}
+			}
+
+			//UVs
+			{
+				if(p.findAttribute("TEXCOORD_0") != p.attributes.end()) {
+					fastgltf::Accessor& uvAccess = model->accessors[p.findAttribute("TEXCOORD_0")->accessorIndex];
+					fastgltf::iterateAccessorWithIndex<glm::vec2>(*model, uvAccess, [&](glm::vec2 aV, uint32_t aId) {
+						assert(initialId+aId < vertices.size());
+						vertices[initialId+aId].texCoords.x = aV.x;
+						vertices[initialId+aId].texCoords.y = 1.0 - aV.y; //flipping UVs Y simpler than flipping every image!
+					});
+				}
+			}
+
+			//joints
+			{
+				if(p.findAttribute("JOINTS_0") != p.attributes.end()) {
+					fastgltf::Accessor& jointsAccess = model->accessors[p.findAttribute("JOINTS_0")->accessorIndex];
+					fastgltf::iterateAccessorWithIndex<fastgltf::math::u8vec4>(*model, jointsAccess, [&](fastgltf::math::u8vec4 aV, uint32_t aId) {
+						vertices[initialId+aId].boneIds[0] = aV.x()+meshNode.jointsIdOffset;
+						vertices[initialId+aId].boneIds[1] = aV.y()+meshNode.jointsIdOffset;
+						vertices[initialId+aId].boneIds[2] = aV.z()+meshNode.jointsIdOffset;
+						vertices[initialId+aId].boneIds[3] = aV.w()+meshNode.jointsIdOffset;
+					});
+				}
+			}
+
+			//weights
+			{
+				if(p.findAttribute("WEIGHTS_0") != p.attributes.end()) {
+					fastgltf::Accessor& jointsAccess = model->accessors[p.findAttribute("WEIGHTS_0")->accessorIndex];
+					fastgltf::iterateAccessorWithIndex<fastgltf::math::fvec4>(*model, jointsAccess, [&](fastgltf::math::fvec4 aV, uint32_t aId) {
+						vertices[initialId+aId].boneWeights[0] = aV.x();
+						vertices[initialId+aId].boneWeights[1] = aV.y();
+						vertices[initialId+aId].boneWeights[2] = aV.z();
+						vertices[initialId+aId].boneWeights[3] = aV.w();
+
+						//sanity check
+						assert(aV.x()+aV.y()+aV.z()+aV.w() > 0.95 || aV.x()+aV.y()+aV.z()+aV.w() == 0.0);
+					});
+				}
+			}
+		}
+
+		//mesh names are non-descriptive usually, use node names (1 node can only have 1 mesh and vice versa)
+		std::cout << "Mesh name: " << meshNode.name << '\n';
+		this->mMeshes.back().transform = meshNode.transformMatrix;
+		this->mMeshes.back().nodeId = meshNodeAccess[meshNodeAccessorId];
+		getJointBounds(this->mMeshes.back());
+		meshNodeAccessorId++;
+	}
+
+	//mesh LODs, meshes are independent
+	auto buildLODs = [&](uint64_t aId) {
+		getMeshLODs(this->mMeshes[aId]);
+	};
+	if(aJobs) aJobs->parallelFor(this->mMeshes.size(), 1, buildLODs);
+	else for(uint64_t i = 0; i < this->mMeshes.size(); i++) buildLODs(i);
+
+	//process animations
+	for(fastgltf::Animation& a : model->animations) {
+		this->mAnimations.push_back({});
+		auto& anim = this->mAnimations.back();
+		anim.mName = a.name.c_str();
+		std::cout << "Found animation: " << a.name.c_str() << '\n';
+
+		for(fastgltf::AnimationSampler& s : a.samplers) {
+			anim.mSamplers.push_back({});
+
+			fastgltf::Accessor& samplerInputAccess = model->accessors[s.inputAccessor]; //time
+			fastgltf::Accessor& samplerOutputAccess = model->accessors[s.outputAccessor]; //value
+
+			//input - keyframe times
+
+			fastgltf::iterateAccessor<float>(*model, samplerInputAccess, [&](float aV) {
+				anim.mSamplers.back().time.push_back(aV);
+			});
+
+			//output - property (vec3 for transform, scale - vec4 for rotation quaternion)
+			if(samplerOutputAccess.type == fastgltf::AccessorType::Vec3) {
+				fastgltf::iterateAccessor<glm::vec3>(*model, samplerOutputAccess, [&](glm::vec3 aV) {
+					anim.mSamplers.back().value.push_back(glm::vec4(aV, 1.0));
+				});
+			}
+			else if(samplerOutputAccess.type == fastgltf::AccessorType::Vec4) {
+				fastgltf::iterateAccessor<glm::vec4>(*model, samplerOutputAccess, [&](glm::vec4 aV) {
+					anim.mSamplers.back().value.push_back(aV);
+				});
+			}
+			else {
+				std::cerr << "Wrong type!\n";
+			} //should never happen, GLTF stores "keyframes" only as vec3 or vec4
+		}
+		for(fastgltf::AnimationChannel& c : a.channels) {
+			anim.mSamplers[c.samplerIndex].type = c.path;
+			if(c.nodeIndex.has_value()) {
+				anim.mSamplers[c.samplerIndex].nodeIndex = c.nodeIndex.value();
+			}
+			else {
+				anim.mSamplers[c.samplerIndex].nodeIndex = -1;
+			}
+		}
+
+		//empty samplers would index out of range when sampled
+		std::erase_if(anim.mSamplers, [](const SamplerData& aSampler) {
+			return aSampler.time.empty() || aSampler.value.size() < aSampler.time.size();
+		});
+		anim.getTimeRange();
+	}
+	this->getRootMotion();
+}
+
+void ModelData::resetPose(Pose& aPose) const noexcept {
+	aPose.translation.resize(this->mNodes.size());
+	aPose.rotation.resize(this->mNodes.size());
+	aPose.scale.resize(this->mNodes.size());
+	aPose.globalMatrix.resize(this->mNodes.size());
+
+	for(uint64_t i = 0; i < this->mNodes.size(); i++) {
+		aPose.translation[i] = this->mNodes[i].translation;
+		aPose.rotation[i] = this->mNodes[i].rotation;
+		aPose.scale[i] = this->mNodes[i].scale;
+	}
+}
+void ModelData::setStateAtTime(Pose& aPose, const uint64_t aId, const float aTime, const uint64_t aJointLevel) const noexcept {
+	this->resetPose(aPose);
+	if(aId >= this->mAnimations.size()) return;
+	if(aJointLevel == 0 || this->mJointLevelMasks.empty()) {
+		this->mAnimations[aId].setStateAtTime(aPose, aTime);
+		return;
+	}
+	uint64_t level = std::min<uint64_t>(aJointLevel, this->mJointLevelMasks.size());
+	this->mAnimations[aId].setStateAtTime(aPose, aTime, this->mJointLevelMasks[level-1]);
+}
+
+void ModelData::updateGlobalMatrices(Pose& aPose) const noexcept {
+	if(aPose.globalMatrix.size() != this->mNodes.size()) aPose.globalMatrix.resize(this->mNodes.size());
+
+	for(uint64_t id : this->mEvaluationOrder) {
+		glm::mat4 local = glm::translate(glm::mat4(1.0f), aPose.translation[id]) * glm::mat4_cast(aPose.rotation[id]) * glm::scale(glm::mat4(1.0f), aPose.scale[id]);
+		int64_t parent = this->mNodes[id].parent;
+		aPose.globalMatrix[id] = parent == -1 ? local : aPose.globalMatrix[parent] * local;
+	}
+}
+
+//https://registry.khronos.org/glTF/specs/2.0/glTF-2.0.html
+//https://www.khronos.org/files/gltf20-reference-guide.pdf
+//https://github.com/SaschaWillems/Vulkan/blob/master/examples/gltfskinning/README.md
+//https://github.com/SaschaWillems/Vulkan/blob/master/examples/gltfskinning/gltfskinning.cpp
+
+void ModelData::getJointMatrices(Pose& aPose, std::span<glm::mat4> aJointMatrices) const noexcept {
+	if(aPose.translation.size() != this->mNodes.size()) this->resetPose(aPose);
+	this->updateGlobalMatrices(aPose);
+
+	for(uint64_t nodeId : this->mSkinnedNodes) {
+		const Node& node = this->mNodes[nodeId];
+		const Bone& skin = this->mBones[node.idOfSkin];
+		glm::mat4 inverseTransform = glm::inverse(node.transformMatrix);
+
+		for(uint64_t i = 0; i < skin.joints.size(); i++) {
+			aJointMatrices[node.jointsIdOffset + i] = inverseTransform * aPose.globalMatrix[skin.joints[i]] * skin.inverseBindMatrix[i];
+		}
+	}
+}
+void ModelData::getJointMatrices(Pose& aPose, std::vector<glm::mat4>& aJointMatrices) const noexcept {
+	aJointMatrices.resize(this->mJointsAmount);
+	this->getJointMatrices(aPose, std::span<glm::mat4>(aJointMatrices));
+}
+
+BoundingBox ModelData::getMeshBounds(const uint64_t aMeshId, std::span<const glm::mat4> aJointMatrices) const noexcept {
+	const MeshData& mesh = this->mMeshes[aMeshId];
+	if(mesh.jointBounds.empty() || aJointMatrices.empty()) return mesh.bounds.transform(mesh.transform);
+
+	//skinned vertices are blends of palette[j]*v, each of which is inside joint j's moved sphere
+	BoundingBox result;
+	for(const JointBounds& j : mesh.jointBounds) {
+		if(j.joint >= aJointMatrices.size()) continue;
+		BoundingSphere sphere = j.sphere.transform(aJointMatrices[j.joint]);
+		result.extend(sphere.center - glm::vec3(sphere.radius));
+		result.extend(sphere.center + glm::vec3(sphere.radius));
+	}
+	return result.transform(mesh.transform);
+}
+BoundingBox ModelData::getBounds(std::span<const glm::mat4> aJointMatrices) const noexcept {
+	BoundingBox result;
+	for(uint64_t i = 0; i < this->mMeshes.size(); i++) result.extend(this->getMeshBounds(i, aJointMatrices));
+	return result;
+}
+
+const std::vector<Node>& ModelData::getNodes() const noexcept {
+	return this->mNodes;
+}
+const std::vector<Bone>& ModelData::getBones() const noexcept {
+	return this->mBones;
+}
+const std::vector<MeshData>& ModelData::getMeshes() const noexcept {
+	return this->mMeshes;
+}
+const std::vector<Material>& ModelData::getMaterials() const noexcept {
+	return this->mMaterials;
+}
+const std::vector<int64_t>& ModelData::getMaterialImages() const noexcept {
+	return this->mMaterialImages;
+}
+std::vector<ImageData>& ModelData::getImages() noexcept {
+	return this->mImages;
+}
+const std::vector<Animation>& ModelData::getAnimations() const noexcept {
+	return this->mAnimations;
+}
+
+uint64_t ModelData::getAnimationAmount() const noexcept {
+	return this->mAnimations.size();
+}
+uint64_t ModelData::getJointAmount() const noexcept {
+	return this->mJointsAmount;
+}
+const RootMotion& ModelData::getRootMotion(const uint64_t aId) const noexcept {
+	return this->mRootMotion[aId];
+}
+glm::vec3 ModelData::getRootMotionDelta(const uint64_t aId, const float aFrom, const float aTo) const noexcept {
+	if(aId >= this->mRootMotion.size()) return glm::vec3(0.0f);
+	const RootMotion& motion = this->mRootMotion[aId];
+	if(motion.node == -1) return glm::vec3(0.0f);
+	if(aTo >= aFrom) return motion.getDisplacement(aTo) - motion.getDisplacement(aFrom);
+	return motion.loopDelta - motion.getDisplacement(aFrom) + motion.getDisplacement(aTo);
+}
+void ModelData::removeRootMotion(Pose& aPose, const uint64_t aId, const float aTime, const float aWeight) const noexcept {
+	if(aId >= this->mRootMotion.size()) return;
+	const RootMotion& motion = this->mRootMotion[aId];
+	if(motion.node == -1 || (uint64_t)motion.node >= aPose.translation.size()) return;
+	aPose.translation[motion.node] -= aWeight * (motion.fromModel * motion.getDisplacement(aTime));
+}
+
+float CompressionReport::getRatio() const noexcept {
+	return this->compressedBytes > 0 ? (float)this->rawBytes / this->compressedBytes : 0.0f;
+}
+
+std::vector<CompressionReport> ModelData::compressAnimations(const CompressionSettings& aSettings) noexcept {
+	std::vector<CompressionReport> reports;
+	if(this->mAnimations.empty()) return reports;
+
+	//bind pose scale of the model picks the defaults
+	Pose rest;
+	std::vector<glm::mat4> jointMatrices(this->mJointsAmount);
+	this->getJointMatrices(rest, jointMatrices);
+	BoundingBox bounds = this->getBounds(jointMatrices);
+	float diagonal = bounds.isEmpty() ? 1.0f : std::max(glm::length(bounds.max - bounds.min), 1e-6f);
+	float budget = aSettings.errorBudget > 0.0f ? aSettings.errorBudget : diagonal * 0.001f;
+	float minimumReach = aSettings.minimumReach > 0.0f ? aSettings.minimumReach : diagonal * 0.05f;
+
+	//reach = distance to the farthest node below at rest, what a rotation error of the node swings around
+	//errors add up down a chain, so the budget is split over the longest root to leaf chain through the node
+	std::vector<float> budgets(this->mNodes.size()), reaches(this->mNodes.size(), 0.0f);
+	std::vector<uint64_t> depth(this->mNodes.size(), 1), height(this->mNodes.size(), 1);
+	for(uint64_t id : this->mEvaluationOrder) {
+		int64_t parent = this->mNodes[id].parent;
+		if(parent != -1) depth[id] = depth[parent] + 1;
+	}
+	for(uint64_t id = 0; id < this->mNodes.size(); id++) {
+		glm::vec3 position = glm::vec3(rest.globalMatrix[id][3]);
+		uint64_t below = 1;
+		for(int64_t parent = this->mNodes[id].parent; parent != -1; parent = this->mNodes[parent].parent) {
+			reaches[parent] = std::max(reaches[parent], glm::distance(position, glm::vec3(rest.globalMatrix[parent][3])));
+			height[parent] = std::max(height[parent], ++below);
+		}
+	}
+	for(uint64_t id = 0; id < this->mNodes.size(); id++) {
+		reaches[id] = std::max(reaches[id], minimumReach);
+		float nodeBudget = id < aSettings.nodeBudgets.size() && aSettings.nodeBudgets[id] > 0.0f ? aSettings.nodeBudgets[id] : budget;
+		budgets[id] = nodeBudget / (depth[id] + height[id] - 1);
+	}
+
+	//measured at 60 Hz: every node and 3 points around it at minimumReach (stand-ins for the skin)
+	Pose pose;
+	auto getPoints = [&](const Animation& aAnimation, const float aTime, glm::vec3* aPoints) {
+		this->resetPose(pose);
+		aAnimation.setStateAtTime(pose, aTime);
+		this->updateGlobalMatrices(pose);
+		for(uint64_t id = 0; id < this->mNodes.size(); id++) {
+			const glm::mat4& global = pose.globalMatrix[id];
+			aPoints[id*4] = glm::vec3(global[3]);
+			for(uint64_t axis = 0; axis < 3; axis++) aPoints[id*4 + axis + 1] = glm::vec3(global[3] + global[axis] * minimumReach);
+		}
+	};
+	std::vector<glm::vec3> reference, points(this->mNodes.size()*4);
+
+	for(Animation& animation : this->mAnimations) {
+		if(animation.isCompressed() || animation.isResampled() || animation.isShared()) continue;
+		CompressionReport report = { std::string(animation.getName()), animation.getMemorySize(), 0, animation.getKeyAmount(), 0, 0.0f };
+		report.tracks = animation.mSamplers.size();
+
+		uint64_t frames = std::ceil(animation.getDuration() * 60.0f) + 1;
+		auto getTime = [&](const uint64_t aFrame) { return std::min(animation.getStart() + aFrame / 60.0f, animation.getEnd()); };
+		reference.resize(frames * points.size());
+		for(uint64_t f = 0; f < frames; f++) getPoints(animation, getTime(f), reference.data() + f*points.size());
+
+		animation.compress(aSettings.sampleRate, budgets, reaches, rest);
+
+		for(uint64_t f = 0; f < frames; f++) {
+			getPoints(animation, getTime(f), points.data());
+			for(uint64_t p = 0; p < points.size(); p++) report.maxError = std::max(report.maxError, glm::distance(points[p], reference[f*points.size() + p]));
+		}
+		report.compressedBytes = animation.getMemorySize();
+		report.compressedKeys = animation.getKeyAmount();
+		report.rawTracks = animation.mSamplers.size();
+		report.compressed = animation.isCompressed();
+		std::cout << "Compressed animation: " << report.name << ", " << report.rawBytes << " -> " << report.compressedBytes << " bytes (" << report.getRatio() << "x), " <<
+		report.rawKeys << " -> " << report.compressedKeys << " keys, " << report.rawTracks << "/" << report.tracks << " tracks raw" <<
+		(report.compressed ? "" : " (not smaller compressed)") << ", max error " << report.maxError << '\n';
+		reports.push_back(report);
+	}
+	return reports;
+}
+
+std::pair<uint64_t, uint64_t> ModelData::resampleAnimations(const float aSampleRate) noexcept {
+	std::pair<uint64_t, uint64_t> size = { 0, 0 };
+	if(aSampleRate <= 0.0f) {
+		std::cerr << "Error: cannot resample animations at " << aSampleRate << " Hz!\n";
+		return size;
+	}
+	Pose rest;
+	this->resetPose(rest);
+	for(Animation& animation : this->mAnimations) {
+		size.first += animation.getMemorySize();
+		animation.resample(aSampleRate, rest);
+		size.second += animation.getMemorySize();
+	}
+	std::cout << "Resampled animations at " << aSampleRate << " Hz: " << size.first << " -> " << size.second << " bytes\n";
+	return size;
+}
+
+void ModelData::getNodeMask(const uint64_t aRootNode, std::vector<uint8_t>& aMask) const noexcept {
+	aMask.assign(this->mNodes.size(), 0);
+	for(uint64_t id : this->mEvaluationOrder) {
+		int64_t parent = this->mNodes[id].parent;
+		aMask[id] = id == aRootNode || (parent != -1 && aMask[parent]);
+	}
+}
+uint64_t ModelData::getMeshLOD(const float aCoverage) noexcept {
+	uint64_t level = 0;
+	while(level < MeshLODCoverage.size() && aCoverage < MeshLODCoverage[level]) level++;
+	return level;
+}
+uint64_t ModelData::getJointLevelAmount() const noexcept {
+	return this->mJointLevelMasks.size() + 1;
+}
+
+ModelData::~ModelData() noexcept {}
+
+void ModelData::loadImages(fastgltf::Asset& aAsset, const std::filesystem::path& aDirectory, std::vector<uint64_t>& aIndices, const ImageFilter& aImageFilter, JobSystem* aJobs) noexcept {
+	std::sort(aIndices.begin(), aIndices.end());
+	aIndices.erase(std::unique(aIndices.begin(), aIndices.end()), aIndices.end());
+	auto decode = [&](uint64_t aId) {
+		decodeImage(aAsset, aDirectory, aIndices[aId], this->mImages[aIndices[aId]], aImageFilter);
+	};
+	if(aJobs) aJobs->parallelFor(aIndices.size(), 1, decode);
+	else for(uint64_t i = 0; i < aIndices.size(); i++) decode(i);
+}
+
+//id is bound to node -> every node will have offset
+void ModelData::getNodeJointAmount() {
+	for(uint64_t nodeId = 0; nodeId < this->mNodes.size(); nodeId++) {
+		if (this->mNodes[nodeId].idOfSkin > -1) {
+			this->mNodes[nodeId].amountOfJoints = this->mBones[this->mNodes[nodeId].idOfSkin].joints.size();
+		}
+	}
+}
+
+//same order as the palette
+void ModelData::getNodeJointOffset(uint64_t aId, uint64_t* aCurrentOffset) {
+	this->mNodes[aId].jointsIdOffset = *aCurrentOffset;
+	*aCurrentOffset += this->mNodes[aId].amountOfJoints;
+	if(this->mNodes[aId].amountOfJoints > 0) this->mSkinnedNodes.push_back(aId);
+
+	for(auto& child : this->mNodes[aId].children) this->getNodeJointOffset(child, aCurrentOffset);
+}
+
+//level 1 drops leaf joints (finger, ear and tail tips), level 2 also the outer half of every chain
+//non-joint nodes are always sampled
+void ModelData::getJointLevels() noexcept {
+	std::vector<uint8_t> isJoint(this->mNodes.size(), 0);
+	for(const Bone& b : this->mBones) {
+		for(uint64_t j : b.joints) if(j < isJoint.size()) isJoint[j] = 1;
+	}
+
+	//joint depth, counted in joints from the skeleton root - parents come first in mEvaluationOrder
+	std::vector<uint64_t> depth(this->mNodes.size(), 0);
+	std::vector<uint8_t> hasJointChild(this->mNodes.size(), 0);
+	uint64_t maxDepth = 0;
+	for(uint64_t id : this->mEvaluationOrder) {
+		int64_t parent = this->mNodes[id].parent;
+		if(!isJoint[id]) continue;
+		depth[id] = parent == -1 ? 1 : depth[parent] + 1;
+		maxDepth = std::max(maxDepth, depth[id]);
+		if(parent != -1) hasJointChild[parent] = 1;
+	}
+	if(maxDepth < 3) return; //nothing worth reducing
+
+	std::vector<uint8_t> level1(this->mNodes.size(), 1), level2(this->mNodes.size(), 1);
+	for(uint64_t i = 0; i < this->mNodes.size(); i++) {
+		if(!isJoint[i]) continue;
+		level1[i] = hasJointChild[i];
+		level2[i] = hasJointChild[i] && depth[i] <= (maxDepth+1)/2;
+	}
+	this->mJointLevelMasks.push_back(std::move(level1));
+	this->mJointLevelMasks.push_back(std::move(level2));
+}
+
+void ModelData::getRootMotion() noexcept {
+	this->mRootMotion.assign(this->mAnimations.size(), {});
+	for(uint64_t a = 0; a < this->mAnimations.size(); a++) this->getAnimationRootMotion(a);
+}
+//root = the translated node closest to the top of the hierarchy
+//runs at load, on the raw keys - views of shared clips get theirs from the AnimationLibrary
+void ModelData::getAnimationRootMotion(const uint64_t aId) noexcept {
+	if(this->mRootMotion.size() <= aId) this->mRootMotion.resize(aId+1);
+	std::vector<uint64_t> depth(this->mNodes.size(), 0);
+	for(uint64_t id : this->mEvaluationOrder) {
+		int64_t parent = this->mNodes[id].parent;
+		depth[id] = parent == -1 ? 0 : depth[parent] + 1;
+	}
+
+	RootMotion& motion = this->mRootMotion[aId];
+	motion = {};
+	const SamplerData* root = nullptr;
+	for(const SamplerData& sampler : this->mAnimations[aId].mSamplers) {
+		int64_t node = sampler.nodeIndex;
+		if(sampler.type != fastgltf::AnimationPath::Translation || node < 0 || (uint64_t)node >= this->mNodes.size()) continue;
+		if(!root || depth[node] < depth[root->nodeIndex]) root = &sampler;
+	}
+	if(!root) return;
+
+	motion.node = root->nodeIndex;
+	int64_t parent = this->mNodes[motion.node].parent;
+	if(parent != -1) {
+		//Node::transformMatrix is local, the whole chain above the root is needed
+		Pose rest;
+		this->resetPose(rest);
+		this->updateGlobalMatrices(rest);
+		motion.toModel = glm::mat3(rest.globalMatrix[parent]);
+	}
+	motion.fromModel = glm::inverse(motion.toModel);
+
+	//cubic spline keys are (in tangent, value, out tangent)
+	uint64_t stride = root->value.size() >= root->time.size()*3 ? 3 : 1;
+	uint64_t offset = stride == 3 ? 1 : 0;
+	glm::vec3 first = glm::vec3(root->value[offset]);
+	motion.time = root->time;
+	motion.displacement.resize(root->time.size());
+	for(uint64_t k = 0; k < root->time.size(); k++) {
+		glm::vec3 displacement = motion.toModel * (glm::vec3(root->value[k*stride + offset]) - first);
+		displacement.y = 0.0f; //model space up, whatever axes the nodes above use
+		motion.displacement[k] = displacement;
+	}
+	motion.loopDelta = motion.displacement.back();
+}
+
+void ModelData::getEvaluationOrder(uint64_t aId) {
+	this->mEvaluationOrder.push_back(aId);
+	for(auto& child : this->mNodes[aId].children) this->getEvaluationOrder(child);
+}
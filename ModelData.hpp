@@ -0,0 +1,216 @@
+#ifndef GLTF_MODELDATA
+#define GLTF_MODELDATA
+#include "Image.hpp"
+#include "Animation.hpp"
+#include "Bounds.hpp"
+
+struct Vertex {
+	glm::vec3 position;
+	glm::vec2 texCoords;
+	glm::vec3 normal;
+	float materialId;
+
+	glm::vec4 boneIds;
+	glm::vec4 boneWeights;
+};
+
+//same layout as the material SSBO (binding 50)
+struct alignas(16) Material {
+	glm::vec4 color = glm::vec4(1.0f);
+	float textureAmount = 1.0f; //1.0 texture only, 0.0 color only
+	int32_t textureSlot = 0;
+	float textureOpacity = 1.0f;
+	float textureFlipped = 1.0f; //0.0 for textures stored top-down (precompressed KTX2 cannot be flipped on load)
+};
+
+//palette entry without the constant (0,0,0,1) row, 3 rows of (x, y, z, translation)
+//binding 51 layout of vertAnimAffine.glsl
+struct AffineMatrix {
+	glm::vec4 rows[3];
+};
+AffineMatrix getAffineMatrix(const glm::mat4& aMatrix) noexcept;
+
+struct Node {
+	std::string name;
+	glm::mat4 originalLocalMatrix;
+	glm::mat4 transformMatrix;
+	int64_t idOfSkin;
+	int64_t meshId = -1;
+
+	//rest pose, ModelData::resetPose starts from this
+	glm::vec3 translation = glm::vec3(0.0f);
+	glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+	glm::vec3 scale = glm::vec3(1.0f);
+
+	std::vector<uint64_t> children;
+	int64_t parent = -1;
+
+	uint64_t amountOfJoints = 0;
+	uint64_t jointsIdOffset = 0;
+
+	Node() noexcept {};
+	Node(const std::string& aName, const glm::mat4& aGlobal, const glm::mat4& aLocal, const int64_t aIdOfSkin) noexcept
+	: name(aName), transformMatrix(aGlobal), originalLocalMatrix(aLocal), idOfSkin(aIdOfSkin) {};
+	~Node() noexcept {};
+};
+
+struct Bone {
+	std::string name;
+	std::vector<uint64_t> joints;
+	std::vector<glm::mat4> inverseBindMatrix;
+};
+
+//index range of one detail level, all levels share the vertex buffer
+struct MeshLOD {
+	uint32_t indexOffset;
+	uint32_t indexAmount;
+	float error; //simplification error, 0 for the full mesh
+};
+
+//vertices/indices of one glTF mesh (all primitives merged), as uploaded by Mesh
+struct MeshData {
+	std::vector<Vertex> vertices;
+	std::vector<uint32_t> indices; //every LOD one after another
+	std::vector<MeshLOD> lods; //0 = full detail
+	glm::mat4 transform;
+	uint64_t nodeId;
+
+	BoundingBox bounds; //bind pose, before transform - from the POSITION accessor min/max
+	std::vector<JointBounds> jointBounds; //skinned vertices only, bind pose, before transform
+};
+
+//horizontal motion of a clip's root node, precomputed at load so the root channel is not sampled again per frame
+struct RootMotion {
+	int64_t node = -1; //-1 = the clip does not translate any node
+	glm::mat3 toModel = glm::mat3(1.0f); //root's parent global matrix at rest, local translation to model space
+	glm::mat3 fromModel = glm::mat3(1.0f);
+	std::vector<float> time;
+	std::vector<glm::vec3> displacement; //model space, from the first key, up (Y) removed
+	glm::vec3 loopDelta = glm::vec3(0.0f); //displacement over the whole clip
+
+	//clamped to the clip's keys
+	glm::vec3 getDisplacement(const float aTime) const noexcept;
+};
+
+//error budget for ModelData::compressAnimations, in model space units
+struct CompressionSettings {
+	float errorBudget = 0.0f; //0 = 0.1% of the bind pose bounds diagonal
+	std::vector<float> nodeBudgets; //per node, missing or 0 = errorBudget
+	float sampleRate = 0.0f; //key grid in Hz, 0 = each clip's own (shortest key interval)
+	float minimumReach = 0.0f; //end joints still move skin around them, 0 = 5% of the bounds diagonal
+};
+
+//per clip result of ModelData::compressAnimations
+struct CompressionReport {
+	std::string name;
+	uint64_t rawBytes, compressedBytes;
+	uint64_t rawKeys, compressedKeys;
+	float maxError; //measured, model space - node positions and points at minimumReach around them
+	uint64_t tracks = 0, rawTracks = 0; //channels of the clip, the ones kept as raw samplers
+	bool compressed = false; //false = the whole clip stayed raw, compressing it saved nothing
+
+	float getRatio() const noexcept;
+};
+
+class JobSystem;
+
+//called from loader threads with an image's key, return true to skip decoding it (already uploaded elsewhere)
+using ImageFilter = std::function<bool(const std::string& aKey)>;
+
+//CPU side of a glTF model: import, node hierarchy, animations and skinning palettes
+//no GL - the immutable asset is shared, per instance state lives in Pose
+class ModelData {
+	friend class AnimationLibrary;
+public:
+	ModelData() noexcept;
+	//aJobs decodes images and builds mesh LODs in parallel (nullptr = calling thread only)
+	ModelData(const std::filesystem::path& aPath, const ImageFilter& aImageFilter = nullptr, JobSystem* aJobs = nullptr) noexcept;
+	ModelData(ModelData&& aOther) noexcept = default;
+	ModelData& operator=(ModelData&& aOther) noexcept = default;
+	ModelData(ModelData& aOther) noexcept = delete;
+	ModelData& operator=(ModelData& aOther) noexcept = delete;
+
+	//rest pose, sized for our nodes
+	void resetPose(Pose& aPose) const noexcept;
+	//reset + apply animation aId
+	//aJointLevel > 0 samples a reduced joint set, dropped joints keep their rest pose and follow their parent
+	void setStateAtTime(Pose& aPose, const uint64_t aId, const float aTime, const uint64_t aJointLevel = 0) const noexcept;
+
+	//evaluates aPose.globalMatrix from local TRS, parents first
+	void updateGlobalMatrices(Pose& aPose) const noexcept;
+	//skinning palette (binding 51 layout), aJointMatrices must hold getJointAmount() matrices
+	//evaluates global matrices as well
+	void getJointMatrices(Pose& aPose, std::span<glm::mat4> aJointMatrices) const noexcept;
+	void getJointMatrices(Pose& aPose, std::vector<glm::mat4>& aJointMatrices) const noexcept;
+
+	//model space bounds (mesh transform applied), for a palette from getJointMatrices
+	//skinned meshes use their joint spheres moved by the palette, the rest their bind pose box
+	BoundingBox getMeshBounds(const uint64_t aMeshId, std::span<const glm::mat4> aJointMatrices) const noexcept;
+	BoundingBox getBounds(std::span<const glm::mat4> aJointMatrices) const noexcept;
+
+	const std::vector<Node>& getNodes() const noexcept;
+	const std::vector<Bone>& getBones() const noexcept;
+	const std::vector<MeshData>& getMeshes() const noexcept;
+	const std::vector<Material>& getMaterials() const noexcept;
+	//image used by each material, -1 if untextured (texture fallbacks already resolved)
+	const std::vector<int64_t>& getMaterialImages() const noexcept;
+	std::vector<ImageData>& getImages() noexcept;
+	const std::vector<Animation>& getAnimations() const noexcept;
+
+	uint64_t getAnimationAmount() const noexcept;
+	uint64_t getJointAmount() const noexcept;
+	//joint levels for setStateAtTime, 0 = every joint
+	uint64_t getJointLevelAmount() const noexcept;
+	//node mask (Animation::setStateAtTime layout) of aRootNode and everything below it
+	void getNodeMask(const uint64_t aRootNode, std::vector<uint8_t>& aMask) const noexcept;
+	const RootMotion& getRootMotion(const uint64_t aId) const noexcept;
+	//model space root displacement of animation aId from aFrom to aTo, aTo < aFrom = the clip looped in between
+	glm::vec3 getRootMotionDelta(const uint64_t aId, const float aFrom, const float aTo) const noexcept;
+	//keeps the root in place - takes the displacement at aTime out of aPose's root translation (after sampling aId)
+	//blends take each clip's share out, aWeight = the clip's normalized blend weight
+	void removeRootMotion(Pose& aPose, const uint64_t aId, const float aTime, const float aWeight = 1.0f) const noexcept;
+
+	//lossy, in place: every clip resampled, key reduced and quantized within the per node budget
+	//channels (or whole clips) the compressed form is not smaller for stay raw
+	//returns sizes and the measured error per clip (already compressed, resampled or shared clips are skipped)
+	std::vector<CompressionReport> compressAnimations(const CompressionSettings& aSettings = {}) noexcept;
+
+	//every clip to one pose row per frame at aSampleRate - O(1) sampling, at the cost of memory
+	//keys between frames are cut off, use at least the rate the clips were authored at
+	//returns the bytes of key data before and after, over all clips
+	std::pair<uint64_t, uint64_t> resampleAnimations(const float aSampleRate = 30.0f) noexcept;
+
+	//mesh LOD for a screen coverage (see getScreenCoverage), clamped to what each mesh has
+	static uint64_t getMeshLOD(const float aCoverage) noexcept;
+
+	~ModelData() noexcept;
+private:
+	std::vector<uint64_t> mRootNodes;
+	std::vector<uint64_t> mEvaluationOrder; //every node, parents before children
+	std::vector<uint64_t> mSkinnedNodes;
+	std::vector<std::vector<uint8_t>> mJointLevelMasks; //per level above 0, 1 = node is sampled
+
+	std::vector<Node> mNodes;
+	std::vector<Bone> mBones;
+	std::vector<MeshData> mMeshes;
+	std::vector<Material> mMaterials;
+	std::vector<int64_t> mMaterialImages;
+	std::vector<ImageData> mImages;
+	std::vector<Animation> mAnimations;
+	std::vector<RootMotion> mRootMotion; //per animation
+
+	size_t mJointsAmount = 0;
+
+	void loadImages(fastgltf::Asset& aAsset, const std::filesystem::path& aDirectory, std::vector<uint64_t>& aIndices, const ImageFilter& aImageFilter, JobSystem* aJobs) noexcept;
+
+	//workaround: joint ID bound to node, we want to store in array
+	//get order of node, add offset
+	void getNodeJointAmount();
+	void getNodeJointOffset(uint64_t aId, uint64_t* aCurrentOffset); //call AFTER getting amount
+	void getEvaluationOrder(uint64_t aId);
+	void getJointLevels() noexcept;
+	void getRootMotion() noexcept;
+	void getAnimationRootMotion(const uint64_t aId) noexcept;
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "Retarget.hpp"
+
+//lower case, without a namespace prefix
+static std::string getJointKey(const std::string& aName) noexcept {
+	std::string key = aName.substr(aName.find_last_of(':') == std::string::npos ? 0 : aName.find_last_of(':') + 1);
+	std::transform(key.begin(), key.end(), key.begin(), [](unsigned char aChar) { return std::tolower(aChar); });
+	return key;
+}
+//rotation part of a global matrix, scale removed
+static glm::quat getRotation(const glm::mat4& aMatrix) noexcept {
+	glm::mat3 rotation = glm::mat3(aMatrix);
+	for(uint64_t i = 0; i < 3; i++) rotation[i] = glm::length(rotation[i]) > 0.0f ? glm::normalize(rotation[i]) : rotation[i];
+	return glm::normalize(glm::quat_cast(rotation));
+}
+
+Retargeter::Retargeter() noexcept {}
+Retargeter::Retargeter(const ModelData& aSource, const ModelData& aTarget, const std::vector<RetargetPair>& aTable) noexcept
+: mpSource(&aSource), mpTarget(&aTarget) {
+	const std::vector<Node>& sourceNodes = aSource.getNodes();
+	const std::vector<Node>& targetNodes = aTarget.getNodes();
+
+	//source skin joints (every node without a skin) to target nodes, by name
+	std::vector<uint8_t> isJoint(sourceNodes.size(), aSource.getBones().empty() ? 1 : 0);
+	for(const Bone& b : aSource.getBones()) {
+		for(uint64_t j : b.joints) if(j < isJoint.size()) isJoint[j] = 1;
+	}
+	std::unordered_map<std::string, uint64_t> targetByKey;
+	for(uint64_t id = 0; id < targetNodes.size(); id++) targetByKey.emplace(getJointKey(targetNodes[id].name), id);
+	std::vector<int64_t> map(sourceNodes.size(), -1);
+	for(uint64_t id = 0; id < sourceNodes.size(); id++) {
+		if(!isJoint[id]) continue;
+		auto target = targetByKey.find(getJointKey(sourceNodes[id].name));
+		if(target != targetByKey.end()) map[id] = target->second;
+	}
+
+	auto findNode = [](const std::vector<Node>& aNodes, const std::string& aName) -> int64_t {
+		for(uint64_t id = 0; id < aNodes.size(); id++) if(aNodes[id].name == aName) return id;
+		std::cerr << "Error: retarget joint " << aName << " does not exist!\n";
+		return -1;
+	};
+	for(const RetargetPair& pair : aTable) {
+		int64_t source = findNode(sourceNodes, pair.source);
+		int64_t target = findNode(targetNodes, pair.target);
+		if(source == -1 || target == -1) continue;
+		std::replace(map.begin(), map.end(), target, (int64_t)-1); //one source per target
+		map[source] = target;
+	}
+
+	//bind poses, world space
+	Pose sourceRest, targetRest;
+	aSource.resetPose(sourceRest);
+	aSource.updateGlobalMatrices(sourceRest);
+	aTarget.resetPose(targetRest);
+	aTarget.updateGlobalMatrices(targetRest);
+	auto getParentMatrix = [](const std::vector<Node>& aNodes, const Pose& aPose, const uint64_t aId) {
+		return aNodes[aId].parent == -1 ? glm::mat4(1.0f) : aPose.globalMatrix[aNodes[aId].parent];
+	};
+
+	//translation carries over only where the clips move the rig as a whole (hips), every other bone keeps the target's length
+	std::vector<uint8_t> isRoot(sourceNodes.size(), 0);
+	for(uint64_t id = 0; id < aSource.getAnimationAmount(); id++) {
+		int64_t node = aSource.getRootMotion(id).node;
+		if(node != -1) isRoot[node] = 1;
+	}
+
+	for(uint64_t s = 0; s < sourceNodes.size(); s++) {
+		if(map[s] == -1) continue;
+		uint64_t t = map[s];
+
+		//source delta from its bind pose, moved from the source parent's frame to the target parent's
+		glm::quat sourceParent = getRotation(getParentMatrix(sourceNodes, sourceRest, s));
+		glm::quat targetParent = getRotation(getParentMatrix(targetNodes, targetRest, t));
+		glm::quat change = glm::inverse(targetParent) * sourceParent;
+		this->mJoints.push_back({ (uint32_t)s, (uint32_t)t, change, glm::inverse(sourceRest.rotation[s]) * glm::inverse(change) * targetRest.rotation[t] });
+
+		if(!isRoot[s]) continue;
+		glm::mat3 toWorld = glm::mat3(getParentMatrix(sourceNodes, sourceRest, s));
+		glm::mat3 fromWorld = glm::inverse(glm::mat3(getParentMatrix(targetNodes, targetRest, t)));
+		this->mRoots.push_back({ (uint32_t)s, (uint32_t)t, fromWorld * toWorld, sourceRest.translation[s], targetRest.translation[t] });
+	}
+
+	//proportions from the first root's height above the origin
+	if(!this->mRoots.empty()) {
+		float sourceHeight = sourceRest.globalMatrix[this->mRoots[0].source][3].y;
+		float targetHeight = targetRest.globalMatrix[this->mRoots[0].target][3].y;
+		if(std::abs(sourceHeight) > 1e-4f) this->mScale = targetHeight / sourceHeight;
+		for(RootJoint& r : this->mRoots) r.delta *= this->mScale;
+	}
+
+	if(this->mJoints.empty()) std::cerr << "Error: retarget rigs have no joint in common!\n";
+	else std::cout << "Retarget: " << this->mJoints.size() << " joints, scale " << this->mScale << '\n';
+}
+
+void Retargeter::apply(const Pose& aSourcePose, Pose& aTargetPose) const noexcept {
+	for(const RotationJoint& j : this->mJoints) {
+		aTargetPose.rotation[j.target] = glm::normalize(j.pre * aSourcePose.rotation[j.source] * j.post);
+	}
+	for(const RootJoint& r : this->mRoots) {
+		aTargetPose.translation[r.target] = r.targetRest + r.delta * (aSourcePose.translation[r.source] - r.sourceRest);
+	}
+}
+void Retargeter::setStateAtTime(Pose& aSourcePose, Pose& aTargetPose, const uint64_t aAnimation, const float aTime) const noexcept {
+	if(!this->mpSource || !this->mpTarget) return;
+	this->mpSource->setStateAtTime(aSourcePose, aAnimation, aTime);
+	this->mpTarget->resetPose(aTargetPose);
+	this->apply(aSourcePose, aTargetPose);
+}
+
+uint64_t Retargeter::getJointAmount() const noexcept {
+	return this->mJoints.size();
+}
+float Retargeter::getScale() const noexcept {
+	return this->mScale;
+}
+
+Retargeter::~Retargeter() noexcept {}
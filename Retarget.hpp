@@ -0,0 +1,52 @@
+#ifndef GLTF_RETARGET
+#define GLTF_RETARGET
+#include "ModelData.hpp"
+
+//plays clips authored for one rig on another with similar topology but different proportions or joint axes
+//the joint map and bind pose corrections are built once, applying them is 2 quaternion products per joint
+
+//user supplied joint pair, for names the automatic match does not catch
+struct RetargetPair {
+	std::string source;
+	std::string target;
+};
+
+class Retargeter {
+public:
+	Retargeter() noexcept;
+	//aSource: rig the clips were authored for (any model or animation-only file), aTarget: rig that plays them, both must outlive this
+	//joints match by name, case and namespace prefixes ("mixamorig:") ignored - aTable adds or overrides pairs
+	Retargeter(const ModelData& aSource, const ModelData& aTarget, const std::vector<RetargetPair>& aTable = {}) noexcept;
+
+	//aSourcePose sampled on the source rig, writes the mapped joints of aTargetPose (reset it first, the rest keep their values)
+	//rotations carry over as world space deltas from the bind pose, root translation scaled by the hip height ratio,
+	//other joints keep the target's bone lengths
+	void apply(const Pose& aSourcePose, Pose& aTargetPose) const noexcept;
+	//samples source clip aAnimation into aSourcePose (per instance scratch) and applies it
+	void setStateAtTime(Pose& aSourcePose, Pose& aTargetPose, const uint64_t aAnimation, const float aTime) const noexcept;
+
+	uint64_t getJointAmount() const noexcept; //mapped joints
+	float getScale() const noexcept; //target/source hip height
+
+	~Retargeter() noexcept;
+private:
+	//target rotation = pre * source rotation * post
+	struct RotationJoint {
+		uint32_t source, target;
+		glm::quat pre, post;
+	};
+	//root motion nodes of the source clips, target translation = targetRest + delta * (source translation - sourceRest)
+	struct RootJoint {
+		uint32_t source, target;
+		glm::mat3 delta;
+		glm::vec3 sourceRest, targetRest;
+	};
+
+	const ModelData* mpSource = nullptr;
+	const ModelData* mpTarget = nullptr;
+	std::vector<RotationJoint> mJoints;
+	std::vector<RootJoint> mRoots;
+	float mScale = 1.0f;
+};
+
+#endif
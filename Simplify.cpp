@@ -0,0 +1,226 @@
+#include "Simplify.hpp"
+#include <queue>
+
+//a collapse that crosses a skinning boundary costs as much as moving this fraction of the mesh size
+#define SIMPLIFY_SKIN_PENALTY 0.1
+//new triangle normal must stay within ~80 degrees of the old one
+#define SIMPLIFY_FLIP_LIMIT 0.2
+
+//symmetric 4x4 as 10 values
+struct Quadric {
+	double a2 = 0, ab = 0, ac = 0, ad = 0, b2 = 0, bc = 0, bd = 0, c2 = 0, cd = 0, d2 = 0;
+
+	void addPlane(const glm::dvec3& aNormal, const double aDistance, const double aWeight) noexcept {
+		double a = aNormal.x, b = aNormal.y, c = aNormal.z, d = aDistance;
+		this->a2 += a*a*aWeight; this->ab += a*b*aWeight; this->ac += a*c*aWeight; this->ad += a*d*aWeight;
+		this->b2 += b*b*aWeight; this->bc += b*c*aWeight; this->bd += b*d*aWeight;
+		this->c2 += c*c*aWeight; this->cd += c*d*aWeight;
+		this->d2 += d*d*aWeight;
+	}
+	void add(const Quadric& aOther) noexcept {
+		this->a2 += aOther.a2; this->ab += aOther.ab; this->ac += aOther.ac; this->ad += aOther.ad;
+		this->b2 += aOther.b2; this->bc += aOther.bc; this->bd += aOther.bd;
+		this->c2 += aOther.c2; this->cd += aOther.cd;
+		this->d2 += aOther.d2;
+	}
+	double evaluate(const glm::dvec3& aPoint) const noexcept {
+		double x = aPoint.x, y = aPoint.y, z = aPoint.z;
+		return std::abs(
+			this->a2*x*x + 2*this->ab*x*y + 2*this->ac*x*z + 2*this->ad*x +
+			this->b2*y*y + 2*this->bc*y*z + 2*this->bd*y +
+			this->c2*z*z + 2*this->cd*z +
+			this->d2
+		);
+	}
+};
+
+struct Collapse {
+	double cost;
+	uint32_t from, to;
+	uint32_t fromVersion, toVersion;
+
+	bool operator>(const Collapse& aOther) const noexcept {
+		return this->cost > aOther.cost;
+	}
+};
+
+//L1 distance of the two skinning weight sets, 0 = same influences, 2 = nothing in common
+static double getSkinDistance(const Vertex& aA, const Vertex& aB) noexcept {
+	double distance = 0.0;
+	for(int i = 0; i < 4; i++) {
+		if(aA.boneWeights[i] <= 0.0f) continue;
+		float other = 0.0f;
+		for(int j = 0; j < 4; j++) if(aB.boneIds[j] == aA.boneIds[i]) other += aB.boneWeights[j];
+		distance += std::abs(aA.boneWeights[i] - other);
+	}
+	for(int i = 0; i < 4; i++) {
+		if(aB.boneWeights[i] <= 0.0f) continue;
+		bool shared = false;
+		for(int j = 0; j < 4; j++) if(aA.boneIds[j] == aB.boneIds[i] && aA.boneWeights[j] > 0.0f) shared = true;
+		if(!shared) distance += aB.boneWeights[i];
+	}
+	return distance;
+}
+
+std::vector<uint32_t> simplifyMesh(const std::vector<Vertex>& aVertices, std::span<const uint32_t> aIndices, const uint64_t aTargetIndexAmount, float& aError) noexcept {
+	aError = 0.0f;
+	uint64_t triangleAmount = aIndices.size() / 3;
+	std::vector<uint32_t> triangles(aIndices.begin(), aIndices.begin() + triangleAmount*3);
+	if(triangles.size() <= aTargetIndexAmount) return triangles;
+
+	//flat shaded exports give every triangle its own vertices - the collapses run on vertices welded by everything
+	//but the normal, so there is topology to collapse along, while every corner keeps a vertex of its own (corners)
+	std::vector<uint32_t> corners = triangles;
+	std::unordered_map<std::string, uint32_t> welded;
+	std::unordered_map<uint32_t, std::vector<uint32_t>> members; //welded vertex -> vertices only the normal tells apart
+	for(uint32_t& id : triangles) {
+		const Vertex& v = aVertices[id];
+		std::array<float, 14> key = {
+			v.position.x, v.position.y, v.position.z, v.texCoords.x, v.texCoords.y, v.materialId,
+			v.boneIds.x, v.boneIds.y, v.boneIds.z, v.boneIds.w, v.boneWeights.x, v.boneWeights.y, v.boneWeights.z, v.boneWeights.w
+		};
+		auto [weld, added] = welded.try_emplace(std::string((const char*)key.data(), sizeof(key)), id);
+		std::vector<uint32_t>& group = members[weld->second];
+		if(std::find(group.begin(), group.end(), id) == group.end()) group.push_back(id);
+		id = weld->second;
+	}
+	//vertex of aWeld facing like aCorner did, the corner moves there
+	auto getCorner = [&](const uint32_t aWeld, const uint32_t aCorner) {
+		uint32_t best = aWeld;
+		float bestFacing = -2.0f;
+		for(uint32_t m : members[aWeld]) {
+			float facing = glm::dot(aVertices[m].normal, aVertices[aCorner].normal);
+			if(facing > bestFacing) {
+				best = m;
+				bestFacing = facing;
+			}
+		}
+		return best;
+	};
+
+	std::vector<uint8_t> alive(triangleAmount, 1);
+	std::vector<std::vector<uint32_t>> adjacency(aVertices.size()); //vertex -> triangles, may hold dead ones
+	std::vector<Quadric> quadrics(aVertices.size());
+	std::vector<uint8_t> locked(aVertices.size(), 0);
+	std::vector<uint32_t> version(aVertices.size(), 0);
+	std::vector<uint8_t> removed(aVertices.size(), 0);
+
+	BoundingBox bounds;
+	for(uint32_t id : triangles) bounds.extend(aVertices[id].position);
+	double extent = glm::length(bounds.max - bounds.min);
+	double skinPenalty = SIMPLIFY_SKIN_PENALTY*SIMPLIFY_SKIN_PENALTY * extent*extent;
+
+	//plane quadrics, area weighted
+	std::unordered_map<uint64_t, uint32_t> edges; //min << 32 | max -> triangle count
+	for(uint64_t t = 0; t < triangleAmount; t++) {
+		uint32_t* tri = &triangles[t*3];
+		if(tri[0] == tri[1] || tri[1] == tri[2] || tri[0] == tri[2]) {
+			alive[t] = 0;
+			continue;
+		}
+
+		glm::dvec3 p0 = aVertices[tri[0]].position, p1 = aVertices[tri[1]].position, p2 = aVertices[tri[2]].position;
+		glm::dvec3 normal = glm::cross(p1 - p0, p2 - p0);
+		double area = glm::length(normal);
+		if(area > 0.0) normal /= area;
+		for(int i = 0; i < 3; i++) {
+			quadrics[tri[i]].addPlane(normal, -glm::dot(normal, p0), area);
+			adjacency[tri[i]].push_back(t);
+
+			uint32_t a = tri[i], b = tri[(i+1)%3];
+			edges[(uint64_t)std::min(a, b) << 32 | std::max(a, b)]++;
+		}
+	}
+
+	//open edges stay where they are - mesh borders, and UV/normal seams since split vertices do not share edges
+	for(auto& [key, count] : edges) {
+		if(count != 1) continue;
+		locked[key >> 32] = 1;
+		locked[key & 0xFFFFFFFF] = 1;
+	}
+
+	std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+	auto pushCollapse = [&](const uint32_t aFrom, const uint32_t aTo) {
+		if(locked[aFrom] || removed[aFrom] || removed[aTo]) return;
+		if(aVertices[aFrom].materialId != aVertices[aTo].materialId) return;
+
+		Quadric q = quadrics[aFrom];
+		q.add(quadrics[aTo]);
+		double cost = q.evaluate(aVertices[aTo].position) + getSkinDistance(aVertices[aFrom], aVertices[aTo])*skinPenalty;
+		queue.push({ cost, aFrom, aTo, version[aFrom], version[aTo] });
+	};
+	for(auto& [key, count] : edges) {
+		pushCollapse(key >> 32, key & 0xFFFFFFFF);
+		pushCollapse(key & 0xFFFFFFFF, key >> 32);
+	}
+
+	uint64_t aliveAmount = std::count(alive.begin(), alive.end(), 1);
+	double maxCost = 0.0;
+	while(aliveAmount*3 > aTargetIndexAmount && !queue.empty()) {
+		Collapse c = queue.top();
+		queue.pop();
+		if(removed[c.from] || removed[c.to] || version[c.from] != c.fromVersion || version[c.to] != c.toVersion) continue;
+
+		//reject collapses that flip a remaining triangle
+		bool flips = false;
+		glm::dvec3 target = aVertices[c.to].position;
+		for(uint32_t t : adjacency[c.from]) {
+			if(!alive[t]) continue;
+			uint32_t* tri = &triangles[t*3];
+			if(tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) continue;
+
+			glm::dvec3 p[3], q[3];
+			for(int i = 0; i < 3; i++) {
+				p[i] = aVertices[tri[i]].position;
+				q[i] = tri[i] == c.from ? target : p[i];
+			}
+			glm::dvec3 before = glm::cross(p[1] - p[0], p[2] - p[0]);
+			glm::dvec3 after = glm::cross(q[1] - q[0], q[2] - q[0]);
+			if(glm::dot(before, after) < SIMPLIFY_FLIP_LIMIT * glm::length(before) * glm::length(after)) {
+				flips = true;
+				break;
+			}
+		}
+		if(flips) continue;
+
+		for(uint32_t t : adjacency[c.from]) {
+			if(!alive[t]) continue;
+			uint32_t* tri = &triangles[t*3];
+			if(tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+				alive[t] = 0;
+				aliveAmount--;
+				continue;
+			}
+			for(int i = 0; i < 3; i++) {
+				if(tri[i] != c.from) continue;
+				tri[i] = c.to;
+				corners[t*3 + i] = getCorner(c.to, corners[t*3 + i]);
+			}
+			adjacency[c.to].push_back(t);
+		}
+		adjacency[c.from].clear();
+		removed[c.from] = 1;
+		quadrics[c.to].add(quadrics[c.from]);
+		version[c.to]++;
+		maxCost = std::max(maxCost, c.cost);
+
+		//costs around the surviving vertex changed
+		std::erase_if(adjacency[c.to], [&](uint32_t aT) { return !alive[aT]; });
+		for(uint32_t t : adjacency[c.to]) {
+			for(int i = 0; i < 3; i++) {
+				uint32_t n = triangles[t*3 + i];
+				if(n == c.to) continue;
+				pushCollapse(n, c.to);
+				pushCollapse(c.to, n);
+			}
+		}
+	}
+
+	std::vector<uint32_t> result;
+	result.reserve(aliveAmount*3);
+	for(uint64_t t = 0; t < triangleAmount; t++) {
+		if(alive[t]) result.insert(result.end(), corners.begin() + t*3, corners.begin() + t*3 + 3);
+	}
+	aError = std::sqrt(maxCost);
+	return result;
+}
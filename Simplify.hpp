@@ -0,0 +1,13 @@
+#ifndef GLTF_SIMPLIFY
+#define GLTF_SIMPLIFY
+#include "ModelData.hpp"
+
+//quadric error metric edge collapse (Garland/Heckbert), vertices are never moved or created
+//- collapses go onto existing vertices, so every level indexes the same vertex buffer
+//- vertices differing only in their normal are welded for the collapses, the result still indexes a vertex
+//  with the corner's own normal (the nearest one at the new position), open edges (borders, UV seams) are locked
+//- collapsing across different skinning influences costs extra, different materials never merge
+//returns the new triangle list, aError is the square root of the largest collapse cost
+std::vector<uint32_t> simplifyMesh(const std::vector<Vertex>& aVertices, std::span<const uint32_t> aIndices, const uint64_t aTargetIndexAmount, float& aError) noexcept;
+
+#endif
@@ -0,0 +1,241 @@
+#include "Skinning.hpp"
+
+#ifdef SKINNING_X86
+#include <immintrin.h>
+#endif
+
+//vertices per job, whole multiples of SKINNING_LANES
+#define SKINNING_BLOCK 1024
+
+//column length tolerance for treating a joint as rigid
+#define SKINNING_SCALE_EPSILON 1e-3f
+
+bool getDualQuaternions(std::span<const glm::mat4> aJointMatrices, std::span<DualQuaternion> aDualQuaternions) noexcept {
+	bool rigid = true;
+	for(uint64_t i = 0; i < std::min(aJointMatrices.size(), aDualQuaternions.size()); i++) {
+		const glm::mat4& m = aJointMatrices[i];
+		glm::vec3 scale = glm::vec3(glm::length(glm::vec3(m[0])), glm::length(glm::vec3(m[1])), glm::length(glm::vec3(m[2])));
+		if(glm::any(glm::greaterThan(glm::abs(scale - glm::vec3(1.0f)), glm::vec3(SKINNING_SCALE_EPSILON)))) rigid = false;
+
+		glm::quat rotation = glm::normalize(glm::quat_cast(glm::mat3(glm::vec3(m[0])/scale.x, glm::vec3(m[1])/scale.y, glm::vec3(m[2])/scale.z)));
+		glm::quat dual = 0.5f * glm::quat(0.0f, glm::vec3(m[3])) * rotation;
+		aDualQuaternions[i].real = glm::vec4(rotation.x, rotation.y, rotation.z, rotation.w);
+		aDualQuaternions[i].dual = glm::vec4(dual.x, dual.y, dual.z, dual.w);
+	}
+	return rigid;
+}
+
+glm::vec3 SkinnedVertices::getPosition(const uint64_t aId) const noexcept {
+	return glm::vec3(this->positionX[aId], this->positionY[aId], this->positionZ[aId]);
+}
+glm::vec3 SkinnedVertices::getNormal(const uint64_t aId) const noexcept {
+	return glm::vec3(this->normalX[aId], this->normalY[aId], this->normalZ[aId]);
+}
+
+SkinnedMesh::SkinnedMesh() noexcept {}
+SkinnedMesh::SkinnedMesh(const MeshData& aMesh) noexcept {
+	this->mVertexAmount = aMesh.vertices.size();
+	uint64_t padded = (this->mVertexAmount + SKINNING_LANES - 1) / SKINNING_LANES * SKINNING_LANES;
+
+	//padding is joint 0 with weight 0, skins to the origin and gets cut off by the caller's vertex amount
+	this->mPositionX.resize(padded, 0.0f);
+	this->mPositionY.resize(padded, 0.0f);
+	this->mPositionZ.resize(padded, 0.0f);
+	this->mNormalX.resize(padded, 0.0f);
+	this->mNormalY.resize(padded, 0.0f);
+	this->mNormalZ.resize(padded, 0.0f);
+	for(uint64_t k = 0; k < 4; k++) {
+		this->mJoints[k].resize(padded, 0);
+		this->mWeights[k].resize(padded, 0.0f);
+	}
+
+	for(uint64_t i = 0; i < this->mVertexAmount; i++) {
+		const Vertex& v = aMesh.vertices[i];
+		this->mPositionX[i] = v.position.x;
+		this->mPositionY[i] = v.position.y;
+		this->mPositionZ[i] = v.position.z;
+		this->mNormalX[i] = v.normal.x;
+		this->mNormalY[i] = v.normal.y;
+		this->mNormalZ[i] = v.normal.z;
+		for(uint64_t k = 0; k < 4; k++) {
+			this->mJoints[k][i] = (int32_t)v.boneIds[k];
+			this->mWeights[k][i] = v.boneWeights[k];
+			this->mJointLimit = std::max<uint32_t>(this->mJointLimit, this->mJoints[k][i] + 1);
+		}
+	}
+}
+
+bool SkinnedMesh::skin(std::span<const glm::mat4> aJointMatrices, SkinnedVertices& aOutput, JobSystem* aJobs, const SkinningKernel aKernel) const noexcept {
+	if(aKernel == SkinningKernel::SCALAR) return this->skinScalar(aJointMatrices, aOutput);
+	if(!this->prepare(aJointMatrices, aOutput)) return false;
+	uint64_t padded = this->mPositionX.size();
+
+#ifdef SKINNING_X86
+	static const bool sHasAVX2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+	const float* palette = glm::value_ptr(aJointMatrices[0]);
+	bool useAVX2 = sHasAVX2 && aKernel != SkinningKernel::SSE;
+#endif
+	auto skinBlock = [&](uint64_t aBlock) {
+		uint64_t begin = aBlock*SKINNING_BLOCK;
+		uint64_t end = std::min<uint64_t>(begin + SKINNING_BLOCK, padded);
+#ifdef SKINNING_X86
+		if(useAVX2) this->skinRangeAVX2(palette, aOutput, begin, end);
+		else this->skinRangeSSE(palette, aOutput, begin, end);
+#else
+		this->skinRangeScalar(aJointMatrices, aOutput, begin, end);
+#endif
+	};
+
+	uint64_t blocks = (padded + SKINNING_BLOCK - 1) / SKINNING_BLOCK;
+	if(aJobs && blocks > 1) aJobs->parallelFor(blocks, 1, skinBlock);
+	else for(uint64_t i = 0; i < blocks; i++) skinBlock(i);
+	return true;
+}
+
+bool SkinnedMesh::skinScalar(std::span<const glm::mat4> aJointMatrices, SkinnedVertices& aOutput) const noexcept {
+	if(!this->prepare(aJointMatrices, aOutput)) return false;
+	this->skinRangeScalar(aJointMatrices, aOutput, 0, this->mPositionX.size());
+	return true;
+}
+
+uint64_t SkinnedMesh::getVertexAmount() const noexcept {
+	return this->mVertexAmount;
+}
+
+SkinnedMesh::~SkinnedMesh() noexcept {}
+
+bool SkinnedMesh::prepare(std::span<const glm::mat4> aJointMatrices, SkinnedVertices& aOutput) const noexcept {
+	if(aJointMatrices.size() < std::max<uint32_t>(this->mJointLimit, 1)) {
+		std::cerr << "Error: skinning palette has " << aJointMatrices.size() << " joints, mesh needs " << this->mJointLimit << "!\n";
+		return false;
+	}
+	uint64_t padded = this->mPositionX.size();
+	aOutput.positionX.resize(padded);
+	aOutput.positionY.resize(padded);
+	aOutput.positionZ.resize(padded);
+	aOutput.normalX.resize(padded);
+	aOutput.normalY.resize(padded);
+	aOutput.normalZ.resize(padded);
+	return true;
+}
+
+void SkinnedMesh::skinRangeScalar(std::span<const glm::mat4> aJointMatrices, SkinnedVertices& aOutput, const uint64_t aBegin, const uint64_t aEnd) const noexcept {
+	for(uint64_t i = aBegin; i < aEnd; i++) {
+		glm::mat4 skinMatrix = glm::mat4(0.0f);
+		for(uint64_t k = 0; k < 4; k++) {
+			skinMatrix += this->mWeights[k][i] * aJointMatrices[this->mJoints[k][i]];
+		}
+
+		glm::vec4 position = skinMatrix * glm::vec4(this->mPositionX[i], this->mPositionY[i], this->mPositionZ[i], 1.0f);
+		glm::vec3 normal = glm::mat3(skinMatrix) * glm::vec3(this->mNormalX[i], this->mNormalY[i], this->mNormalZ[i]);
+		float length2 = glm::dot(normal, normal);
+		normal = length2 > 0.0f ? normal / std::sqrt(length2) : glm::vec3(0.0f); //unskinned vertices collapse, as on the GPU
+
+		aOutput.positionX[i] = position.x;
+		aOutput.positionY[i] = position.y;
+		aOutput.positionZ[i] = position.z;
+		aOutput.normalX[i] = normal.x;
+		aOutput.normalY[i] = normal.y;
+		aOutput.normalZ[i] = normal.z;
+	}
+}
+
+#ifdef SKINNING_X86
+
+//4 vertices at a time straight from the streams, like the AVX2 kernel below
+//SSE has no gather - the 4 palette columns of each lane are loaded whole and transposed into rows
+void SkinnedMesh::skinRangeSSE(const float* aPalette, SkinnedVertices& aOutput, const uint64_t aBegin, const uint64_t aEnd) const noexcept {
+	for(uint64_t i = aBegin; i < aEnd; i += 4) {
+		__m128 matrix[12]; //[column*3 + row]
+		for(uint64_t e = 0; e < 12; e++) matrix[e] = _mm_setzero_ps();
+
+		for(uint64_t k = 0; k < 4; k++) {
+			const int32_t* joints = this->mJoints[k].data() + i;
+			__m128 weight = _mm_loadu_ps(this->mWeights[k].data() + i);
+			for(uint64_t c = 0; c < 4; c++) {
+				__m128 row0 = _mm_loadu_ps(aPalette + joints[0]*16 + c*4);
+				__m128 row1 = _mm_loadu_ps(aPalette + joints[1]*16 + c*4);
+				__m128 row2 = _mm_loadu_ps(aPalette + joints[2]*16 + c*4);
+				__m128 row3 = _mm_loadu_ps(aPalette + joints[3]*16 + c*4);
+				_MM_TRANSPOSE4_PS(row0, row1, row2, row3); //rowN = element N of column c, one lane per vertex
+				matrix[c*3] = _mm_add_ps(matrix[c*3], _mm_mul_ps(weight, row0));
+				matrix[c*3 + 1] = _mm_add_ps(matrix[c*3 + 1], _mm_mul_ps(weight, row1));
+				matrix[c*3 + 2] = _mm_add_ps(matrix[c*3 + 2], _mm_mul_ps(weight, row2));
+			}
+		}
+
+		__m128 px = _mm_loadu_ps(this->mPositionX.data() + i);
+		__m128 py = _mm_loadu_ps(this->mPositionY.data() + i);
+		__m128 pz = _mm_loadu_ps(this->mPositionZ.data() + i);
+		__m128 nx = _mm_loadu_ps(this->mNormalX.data() + i);
+		__m128 ny = _mm_loadu_ps(this->mNormalY.data() + i);
+		__m128 nz = _mm_loadu_ps(this->mNormalZ.data() + i);
+
+		__m128 position[3], normal[3];
+		for(uint64_t r = 0; r < 3; r++) {
+			position[r] = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(matrix[r], px), _mm_mul_ps(matrix[3 + r], py)),
+				_mm_add_ps(_mm_mul_ps(matrix[6 + r], pz), matrix[9 + r])
+			);
+			normal[r] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(matrix[r], nx), _mm_mul_ps(matrix[3 + r], ny)), _mm_mul_ps(matrix[6 + r], nz));
+		}
+
+		__m128 length2 = _mm_add_ps(_mm_add_ps(_mm_mul_ps(normal[0], normal[0]), _mm_mul_ps(normal[1], normal[1])), _mm_mul_ps(normal[2], normal[2]));
+		__m128 nonZero = _mm_cmpgt_ps(length2, _mm_setzero_ps());
+		__m128 scale = _mm_and_ps(nonZero, _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(length2)));
+
+		_mm_storeu_ps(aOutput.positionX.data() + i, position[0]);
+		_mm_storeu_ps(aOutput.positionY.data() + i, position[1]);
+		_mm_storeu_ps(aOutput.positionZ.data() + i, position[2]);
+		_mm_storeu_ps(aOutput.normalX.data() + i, _mm_mul_ps(normal[0], scale));
+		_mm_storeu_ps(aOutput.normalY.data() + i, _mm_mul_ps(normal[1], scale));
+		_mm_storeu_ps(aOutput.normalZ.data() + i, _mm_mul_ps(normal[2], scale));
+	}
+}
+
+//8 vertices at a time straight from the streams, palette entries are gathered per lane
+//only the upper 3 rows are needed, the palette is affine
+__attribute__((target("avx2,fma")))
+void SkinnedMesh::skinRangeAVX2(const float* aPalette, SkinnedVertices& aOutput, const uint64_t aBegin, const uint64_t aEnd) const noexcept {
+	for(uint64_t i = aBegin; i < aEnd; i += SKINNING_LANES) {
+		__m256 matrix[12]; //[column*3 + row]
+		for(uint64_t e = 0; e < 12; e++) matrix[e] = _mm256_setzero_ps();
+
+		for(uint64_t k = 0; k < 4; k++) {
+			__m256i offset = _mm256_slli_epi32(_mm256_loadu_si256((const __m256i*)(this->mJoints[k].data() + i)), 4);
+			__m256 weight = _mm256_loadu_ps(this->mWeights[k].data() + i);
+			for(uint64_t c = 0; c < 4; c++) {
+				for(uint64_t r = 0; r < 3; r++) {
+					__m256 element = _mm256_i32gather_ps(aPalette + c*4 + r, offset, 4);
+					matrix[c*3 + r] = _mm256_fmadd_ps(weight, element, matrix[c*3 + r]);
+				}
+			}
+		}
+
+		__m256 px = _mm256_loadu_ps(this->mPositionX.data() + i);
+		__m256 py = _mm256_loadu_ps(this->mPositionY.data() + i);
+		__m256 pz = _mm256_loadu_ps(this->mPositionZ.data() + i);
+		__m256 nx = _mm256_loadu_ps(this->mNormalX.data() + i);
+		__m256 ny = _mm256_loadu_ps(this->mNormalY.data() + i);
+		__m256 nz = _mm256_loadu_ps(this->mNormalZ.data() + i);
+
+		__m256 position[3], normal[3];
+		for(uint64_t r = 0; r < 3; r++) {
+			position[r] = _mm256_fmadd_ps(matrix[r], px, _mm256_fmadd_ps(matrix[3 + r], py, _mm256_fmadd_ps(matrix[6 + r], pz, matrix[9 + r])));
+			normal[r] = _mm256_fmadd_ps(matrix[r], nx, _mm256_fmadd_ps(matrix[3 + r], ny, _mm256_mul_ps(matrix[6 + r], nz)));
+		}
+
+		__m256 length2 = _mm256_fmadd_ps(normal[0], normal[0], _mm256_fmadd_ps(normal[1], normal[1], _mm256_mul_ps(normal[2], normal[2])));
+		__m256 nonZero = _mm256_cmp_ps(length2, _mm256_setzero_ps(), _CMP_GT_OQ);
+		__m256 scale = _mm256_and_ps(nonZero, _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(length2)));
+
+		_mm256_storeu_ps(aOutput.positionX.data() + i, position[0]);
+		_mm256_storeu_ps(aOutput.positionY.data() + i, position[1]);
+		_mm256_storeu_ps(aOutput.positionZ.data() + i, position[2]);
+		_mm256_storeu_ps(aOutput.normalX.data() + i, _mm256_mul_ps(normal[0], scale));
+		_mm256_storeu_ps(aOutput.normalY.data() + i, _mm256_mul_ps(normal[1], scale));
+		_mm256_storeu_ps(aOutput.normalZ.data() + i, _mm256_mul_ps(normal[2], scale));
+	}
+}
+
+#endif
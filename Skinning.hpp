@@ -0,0 +1,79 @@
+#ifndef GLTF_SKINNING
+#define GLTF_SKINNING
+#include "ModelData.hpp"
+#include "JobSystem.hpp"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define SKINNING_X86
+#endif
+
+//CPU skinning for consumers that need skinned geometry without a GPU (picking, collision, headless checks)
+//same math as vertAnim.glsl, output is in mesh space (before MeshData::transform)
+
+//rigid joint transform, 2 vec4 = half a palette matrix (binding 51 layout of vertAnimDQ.glsl)
+//real = rotation (x, y, z, w), dual = 0.5 * translation * real
+struct DualQuaternion {
+	glm::vec4 real;
+	glm::vec4 dual;
+};
+
+//palette from ModelData::getJointMatrices to dual quaternions, aDualQuaternions must be as large
+//scale cannot be represented and is dropped - returns false if any joint had some
+bool getDualQuaternions(std::span<const glm::mat4> aJointMatrices, std::span<DualQuaternion> aDualQuaternions) noexcept;
+
+//skinned vertices as separate streams, padded to a multiple of SKINNING_LANES
+struct SkinnedVertices {
+	std::vector<float> positionX, positionY, positionZ;
+	std::vector<float> normalX, normalY, normalZ;
+
+	glm::vec3 getPosition(const uint64_t aId) const noexcept;
+	glm::vec3 getNormal(const uint64_t aId) const noexcept;
+};
+
+//AVX2 kernel works on 8 vertices at a time
+#define SKINNING_LANES 8
+
+//kernel SkinnedMesh::skin runs, AUTO = AVX2 if the CPU has it, SSE otherwise
+//AVX2 falls back to SSE without CPU support, every kernel is SCALAR outside x86
+enum class SkinningKernel : uint8_t {
+	AUTO = 0,
+	SCALAR,
+	SSE,
+	AVX2
+};
+
+//SoA copy of one mesh's skinning inputs, built once per mesh
+class SkinnedMesh {
+public:
+	SkinnedMesh() noexcept;
+	SkinnedMesh(const MeshData& aMesh) noexcept;
+
+	//aJointMatrices as from ModelData::getJointMatrices, must cover every joint the mesh references
+	//split over aJobs in vertex chunks (nullptr = calling thread only), aKernel only for validation and benchmarks
+	//returns false if the palette is too small
+	bool skin(std::span<const glm::mat4> aJointMatrices, SkinnedVertices& aOutput, JobSystem* aJobs = nullptr, const SkinningKernel aKernel = SkinningKernel::AUTO) const noexcept;
+	//plain per vertex reference, for validation and benchmarks
+	bool skinScalar(std::span<const glm::mat4> aJointMatrices, SkinnedVertices& aOutput) const noexcept;
+
+	uint64_t getVertexAmount() const noexcept;
+
+	~SkinnedMesh() noexcept;
+private:
+	uint64_t mVertexAmount = 0;
+	uint32_t mJointLimit = 0; //highest joint id + 1
+
+	std::vector<float> mPositionX, mPositionY, mPositionZ;
+	std::vector<float> mNormalX, mNormalY, mNormalZ;
+	std::array<std::vector<int32_t>, 4> mJoints;
+	std::array<std::vector<float>, 4> mWeights;
+
+	bool prepare(std::span<const glm::mat4> aJointMatrices, SkinnedVertices& aOutput) const noexcept;
+	//vertices aBegin..aEnd-1, multiples of SKINNING_LANES
+	void skinRangeScalar(std::span<const glm::mat4> aJointMatrices, SkinnedVertices& aOutput, const uint64_t aBegin, const uint64_t aEnd) const noexcept;
+#ifdef SKINNING_X86
+	void skinRangeSSE(const float* aPalette, SkinnedVertices& aOutput, const uint64_t aBegin, const uint64_t aEnd) const noexcept;
+	void skinRangeAVX2(const float* aPalette, SkinnedVertices& aOutput, const uint64_t aBegin, const uint64_t aEnd) const noexcept;
+#endif
+};
+
+#endif
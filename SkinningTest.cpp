@@ -0,0 +1,117 @@
+#include "Skinning.hpp"
+#include <iostream>
+#include <random>
+#include <string>
+
+//headless checks of the SIMD skinning kernels against the scalar reference
+
+//relative to the larger of 1 and the reference value, FMA and summation order differ between kernels
+#define SKINNING_TOLERANCE 1e-5f
+
+static uint64_t sFailed = 0;
+static uint64_t sPassed = 0;
+
+static void check(const bool aCondition, const std::string& aName) noexcept {
+	if(aCondition) {
+		sPassed++;
+		return;
+	}
+	sFailed++;
+	std::cerr << "Error: check " << aName << " failed!\n";
+}
+
+//largest difference of every vertex (padding excluded), scaled by the reference
+static float getError(const SkinnedVertices& aReference, const SkinnedVertices& aOther, const uint64_t aVertexAmount) noexcept {
+	float error = 0.0f;
+	for(uint64_t i = 0; i < aVertexAmount; i++) {
+		glm::vec3 p = aReference.getPosition(i), n = aReference.getNormal(i);
+		glm::vec3 dp = glm::abs(aOther.getPosition(i) - p) / glm::max(glm::abs(p), glm::vec3(1.0f));
+		glm::vec3 dn = glm::abs(aOther.getNormal(i) - n);
+		error = std::max({ error, dp.x, dp.y, dp.z, dn.x, dn.y, dn.z });
+	}
+	return error;
+}
+
+//random mesh over aJointAmount joints, weights sum to 1 except every 97th vertex (unskinned, collapses)
+static MeshData makeMesh(const uint64_t aVertexAmount, const uint64_t aJointAmount, std::mt19937& aRandom) noexcept {
+	std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::uniform_int_distribution<uint64_t> joint(0, aJointAmount - 1);
+
+	MeshData mesh;
+	mesh.vertices.resize(aVertexAmount);
+	for(uint64_t i = 0; i < aVertexAmount; i++) {
+		Vertex& v = mesh.vertices[i];
+		v.position = glm::vec3(position(aRandom), position(aRandom), position(aRandom));
+		v.normal = glm::normalize(glm::vec3(position(aRandom), position(aRandom), position(aRandom)) + glm::vec3(0.01f));
+		v.texCoords = glm::vec2(0.0f);
+		v.materialId = 0.0f;
+		float sum = 0.0f;
+		for(uint64_t k = 0; k < 4; k++) {
+			v.boneIds[k] = (float)joint(aRandom);
+			v.boneWeights[k] = unit(aRandom);
+			sum += v.boneWeights[k];
+		}
+		v.boneWeights = i % 97 == 0 ? glm::vec4(0.0f) : v.boneWeights / sum;
+	}
+	return mesh;
+}
+
+//translation, rotation and non-uniform scale, as getJointMatrices produces
+static std::vector<glm::mat4> makePalette(const uint64_t aJointAmount, std::mt19937& aRandom) noexcept {
+	std::uniform_real_distribution<float> offset(-5.0f, 5.0f);
+	std::uniform_real_distribution<float> angle(-3.14f, 3.14f);
+	std::uniform_real_distribution<float> scale(0.5f, 2.0f);
+
+	std::vector<glm::mat4> palette(aJointAmount);
+	for(glm::mat4& m : palette) {
+		glm::vec3 axis = glm::normalize(glm::vec3(offset(aRandom), offset(aRandom), offset(aRandom)) + glm::vec3(0.01f));
+		m = glm::translate(glm::mat4(1.0f), glm::vec3(offset(aRandom), offset(aRandom), offset(aRandom)));
+		m = glm::rotate(m, angle(aRandom), axis);
+		m = glm::scale(m, glm::vec3(scale(aRandom), scale(aRandom), scale(aRandom)));
+	}
+	return palette;
+}
+
+int main() {
+	std::mt19937 random(7);
+	JobSystem jobs(4);
+
+	//less than one lane block, a lane remainder, several job blocks with a remainder
+	for(uint64_t vertexAmount : { 5ull, 37ull, 4099ull }) {
+		std::string size = std::to_string(vertexAmount);
+		MeshData data = makeMesh(vertexAmount, 40, random);
+		SkinnedMesh mesh(data);
+		std::vector<glm::mat4> palette = makePalette(40, random);
+
+		SkinnedVertices reference;
+		check(mesh.skinScalar(palette, reference), "scalar " + size);
+
+		const std::pair<SkinningKernel, const char*> kernels[] = { { SkinningKernel::SSE, "SSE" }, { SkinningKernel::AVX2, "AVX2" } };
+		for(const auto& [kernel, name] : kernels) {
+			SkinnedVertices single, threaded;
+			check(mesh.skin(palette, single, nullptr, kernel), std::string(name) + " " + size);
+			check(getError(reference, single, vertexAmount) <= SKINNING_TOLERANCE, std::string(name) + " matches scalar " + size);
+			check(mesh.skin(palette, threaded, &jobs, kernel), std::string(name) + " threaded " + size);
+			check(getError(single, threaded, vertexAmount) == 0.0f, std::string(name) + " threaded matches single " + size);
+		}
+
+		//zero weights skin to the origin with a zero normal, as on the GPU
+		SkinnedVertices simd;
+		mesh.skin(palette, simd);
+		check(simd.getPosition(0) == glm::vec3(0.0f) && simd.getNormal(0) == glm::vec3(0.0f), "unskinned vertex collapses " + size);
+	}
+
+	//palette smaller than the joints the mesh references
+	{
+		std::mt19937 meshRandom(11);
+		SkinnedMesh mesh(makeMesh(64, 40, meshRandom));
+		std::vector<glm::mat4> palette = makePalette(8, random);
+		SkinnedVertices output;
+		check(!mesh.skin(palette, output), "short palette rejected");
+		check(!mesh.skinScalar(palette, output), "short palette rejected by scalar");
+	}
+
+	std::cout << "Skinning test: " << sPassed << " passed, " << sFailed << " failed\n";
+	return sFailed == 0 ? 0 : 1;
+}
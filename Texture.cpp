@@ -1,11 +1,29 @@
-#define STB_IMAGE_IMPLEMENTATION
-#define STBI_WINDOWS_UTF8
-#define STBI_FAILURE_USERMSG
-#define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "Texture.hpp"
 
-Texture::Texture(const std::string_view aFilename, const bool aFlip, TextureScale aScaling, TextureBorder aBorder) noexcept
-: mHandle(0), mpData(nullptr), mPath(aFilename), mWidth(0), mHeight(0), mChannels(0) {
+std::atomic<uint64_t> Texture::sTotalCpuMemory = 0;
+std::atomic<uint64_t> Texture::sTotalGpuMemory = 0;
+
+static uint64_t getBytesPerPixel(const uint64_t aInternalFormat) noexcept {
+	switch(aInternalFormat) {
+		case(GL_R8):
+			return 1;
+		case(GL_RG8):
+		case(GL_R16F):
+			return 2;
+		case(GL_RGBA16F):
+		case(GL_RG32F):
+			return 8;
+		case(GL_RGB32F):
+			return 12;
+		case(GL_RGBA32F):
+			return 16;
+		default:
+			return 4; //RGBA8, depth 24/32, RGB8 padded by the driver
+	}
+}
+
+Texture::Texture(const std::string_view aFilename, const bool aFlip, TextureScale aScaling, TextureBorder aBorder, TextureResidency aResidency) noexcept
+: mHandle(0), mpData(nullptr), mPath(aFilename), mWidth(0), mHeight(0), mChannels(0), mFlipped(aFlip), mCpuMemory(0), mGpuMemory(0) {
 	if(this->mPath.empty()) {
 		return;
 	}
@@ -42,21 +60,27 @@ Texture::Texture(const std::string_view aFilename, const bool aFlip, TextureScal
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, glTextureScaleValue2);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, glTextureScaleValue);
 
-	stbi_set_flip_vertically_on_load(aFlip);
+	stbi_set_flip_vertically_on_load_thread(aFlip);
 	this->mpData = stbi_load(mPath.data(), &this->mWidth, &this->mHeight, &this->mChannels, 4);
 	if(!this->mpData) {
 		std::cerr << "STBI failed to load image " << aFilename << "!\n";
+		glDeleteTextures(1, &this->mHandle);
+		this->mHandle = 0;
 		return;
 	}
 
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, this->mWidth, this->mHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, this->mpData);
 	glGenerateMipmap(GL_TEXTURE_2D);
+
+	//mip chain adds a third
+	this->setMemory((uint64_t)this->mWidth*this->mHeight*4, (uint64_t)this->mWidth*this->mHeight*4*4/3);
+	if(aResidency == TextureResidency::RELEASE_AFTER_UPLOAD) this->releaseCpuCopy();
 }
 Texture::Texture(
 	const uint64_t aWidth, const uint64_t aHeight,
 	const uint64_t aInternalFormat, const uint64_t aFormat, const uint64_t aDataType,
 	const bool aNoMipmaps, TextureScale aScaling, TextureBorder aBorder) noexcept
-	: mPath(""), mHandle(0), mpData(nullptr), mWidth(aWidth), mHeight(aHeight), mChannels(0) {
+	: mPath(""), mHandle(0), mpData(nullptr), mWidth(aWidth), mHeight(aHeight), mChannels(0), mFlipped(false), mCpuMemory(0), mGpuMemory(0) {
 		GLint glTextureScaleValue = 0;
 		GLint glTextureScaleValue2 = 0;
 		switch(aScaling) {
@@ -94,10 +118,19 @@ Texture::Texture(
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, glTextureBorderValue);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, glTextureScaleValue2);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, glTextureScaleValue);
+
+		this->setMemory(0, (uint64_t)this->mWidth*this->mHeight*getBytesPerPixel(aInternalFormat));
 	}
 
-Texture::Texture(void* aData, const size_t aPixelAmount, const bool aFlip, TextureScale aScaling, TextureBorder aBorder) noexcept
-	: mPath(""), mHandle(0), mpData(nullptr), mChannels(4) {
+Texture::Texture(void* aData, const size_t aPixelAmount, const bool aFlip, TextureScale aScaling, TextureBorder aBorder, TextureResidency aResidency) noexcept
+	: Texture(TextureData(aData, aPixelAmount, aFlip), aScaling, aBorder, aResidency) {}
+
+Texture::Texture(TextureData&& aData, TextureScale aScaling, TextureBorder aBorder, TextureResidency aResidency) noexcept
+	: mPath(""), mHandle(0), mpData(nullptr), mWidth(aData.width), mHeight(aData.height), mChannels(aData.channels), mFlipped(aData.flipped), mCpuMemory(0), mGpuMemory(0) {
+		if(!aData.pixels) {
+			return; //decoding already reported the error
+		}
+
 		GLint glTextureScaleValue = 0;
 		GLint glTextureScaleValue2 = 0;
 		switch(aScaling) {
@@ -126,12 +159,9 @@ Texture::Texture(void* aData, const size_t aPixelAmount, const bool aFlip, Textu
 		glGenTextures(1, &this->mHandle);
 		glBindTexture(GL_TEXTURE_2D, this->mHandle);
 
-		stbi_set_flip_vertically_on_load(aFlip);
-		this->mpData = stbi_load_from_memory((stbi_uc*)aData, aPixelAmount, &this->mWidth, &this->mHeight, &this->mChannels, 4);
-		if(!this->mpData) {
-			std::cerr << "STBI failed to load image from memory!\n";
-			return;
-		}
+		//we take over the stbi buffer
+		this->mpData = aData.pixels;
+		aData.pixels = nullptr;
 		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, this->mWidth, this->mHeight, 0, GL_RGBA, GL_UNSIGNED_BYTE, this->mpData);
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, glTextureBorderValue);
@@ -140,23 +170,108 @@ Texture::Texture(void* aData, const size_t aPixelAmount, const bool aFlip, Textu
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, glTextureScaleValue);
 
 		glGenerateMipmap(GL_TEXTURE_2D);
+
+		this->setMemory((uint64_t)this->mWidth*this->mHeight*4, (uint64_t)this->mWidth*this->mHeight*4*4/3);
+		if(aResidency == TextureResidency::RELEASE_AFTER_UPLOAD) this->releaseCpuCopy();
 	}
 
-Texture::Texture(Texture&& aOther) noexcept
-	: mPath(std::move(aOther.mPath)), mWidth(aOther.mWidth), mHeight(aOther.mHeight), mChannels(aOther.mChannels) {
-		glDeleteTextures(1, &this->mHandle);
-		this->mHandle = aOther.mHandle;
-		//no free in constructor!
-		this->mpData = aOther.mpData;
+static GLenum getGLFormat(const KTX2Format aFormat) noexcept {
+	switch(aFormat) {
+		case(KTX2Format::RGBA8):          return GL_RGBA8;
+		case(KTX2Format::RGBA8_SRGB):     return GL_SRGB8_ALPHA8;
+		case(KTX2Format::BC1):            return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+		case(KTX2Format::BC1_SRGB):       return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+		case(KTX2Format::BC3):            return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+		case(KTX2Format::BC3_SRGB):       return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+		case(KTX2Format::BC4):            return GL_COMPRESSED_RED_RGTC1;
+		case(KTX2Format::BC5):            return GL_COMPRESSED_RG_RGTC2;
+		case(KTX2Format::BC7):            return GL_COMPRESSED_RGBA_BPTC_UNORM;
+		case(KTX2Format::BC7_SRGB):       return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+		case(KTX2Format::ETC2_RGB):       return GL_COMPRESSED_RGB8_ETC2;
+		case(KTX2Format::ETC2_RGB_SRGB):  return GL_COMPRESSED_SRGB8_ETC2;
+		case(KTX2Format::ETC2_RGBA):      return GL_COMPRESSED_RGBA8_ETC2_EAC;
+		case(KTX2Format::ETC2_RGBA_SRGB): return GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC;
+		default:                          return 0;
+	}
+}
+
+Texture::Texture(const KTX2Image& aImage, TextureScale aScaling, TextureBorder aBorder) noexcept
+	: mPath(""), mHandle(0), mpData(nullptr), mWidth(aImage.width), mHeight(aImage.height), mChannels(4), mFlipped(false), mCpuMemory(0), mGpuMemory(0) {
+		bool hasMipmaps = aImage.levels.size() > 1;
 
+		GLint glTextureScaleValue = 0;
+		GLint glTextureScaleValue2 = 0;
+		switch(aScaling) {
+			case(TextureScale::LINEAR):
+				glTextureScaleValue = GL_LINEAR;
+				//compressed formats cannot use glGenerateMipmap - only use what the file provides
+				glTextureScaleValue2 = hasMipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+				break;
+			case(TextureScale::NEAREST_NEIGHBOR):
+			default:
+				glTextureScaleValue = GL_NEAREST;
+				glTextureScaleValue2 = GL_NEAREST;
+				break;
+		}
+
+		GLint glTextureBorderValue = 0;
+		switch(aBorder) {
+			case(TextureBorder::FILL_OUT_OF_RANGE):
+				glTextureBorderValue = GL_CLAMP_TO_BORDER;
+				break;
+			case(TextureBorder::REPEAT):
+			default:
+				glTextureBorderValue = GL_REPEAT;
+				break;
+		}
+
+		GLenum internalFormat = getGLFormat(aImage.format);
+		if(internalFormat == 0 || aImage.levels.empty()) {
+			std::cerr << "Error: KTX2 image has no uploadable data!\n";
+			return;
+		}
+
+		glGenTextures(1, &this->mHandle);
+		glBindTexture(GL_TEXTURE_2D, this->mHandle);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_BASE_LEVEL, 0);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, aImage.levels.size()-1);
+
+		for(uint64_t i = 0; i < aImage.levels.size(); i++) {
+			const KTX2Level& level = aImage.levels[i];
+			if(aImage.isCompressed()) {
+				glCompressedTexImage2D(GL_TEXTURE_2D, i, internalFormat, level.width, level.height, 0, level.size, level.data);
+			}
+			else {
+				glTexImage2D(GL_TEXTURE_2D, i, internalFormat, level.width, level.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, level.data);
+			}
+		}
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, glTextureBorderValue);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, glTextureBorderValue);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, glTextureScaleValue2);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, glTextureScaleValue);
+
+		//KTX2 data is only borrowed from the asset, nothing kept on CPU
+		this->setMemory(0, aImage.getByteSize());
+	}
+
+Texture::Texture(Texture&& aOther) noexcept
+	: mPath(std::move(aOther.mPath)), mHandle(aOther.mHandle), mpData(aOther.mpData), mWidth(aOther.mWidth), mHeight(aOther.mHeight), mChannels(aOther.mChannels), mFlipped(aOther.mFlipped),
+	mCpuMemory(aOther.mCpuMemory), mGpuMemory(aOther.mGpuMemory) {
+		//nothing to delete yet, we take over the handle and data
 		aOther.mHandle = 0;
 		aOther.mpData = nullptr;
+		aOther.mCpuMemory = 0;
+		aOther.mGpuMemory = 0;
 	}
 Texture& Texture::operator=(Texture&& aOther) noexcept {
 		glDeleteTextures(1, &this->mHandle);
 		this->mHandle = aOther.mHandle;
 		stbi_image_free(this->mpData);
 		this->mpData = aOther.mpData;
+		this->setMemory(0, 0); //our texture is gone, the other one's counts are already in the totals
+		this->mCpuMemory = aOther.mCpuMemory;
+		this->mGpuMemory = aOther.mGpuMemory;
 
 		this->mPath = std::move(aOther.mPath);
 		this->mHandle = aOther.mHandle;
@@ -164,9 +279,12 @@ Texture& Texture::operator=(Texture&& aOther) noexcept {
 		this->mWidth = aOther.mWidth;
 		this->mHeight = aOther.mHeight;
 		this->mChannels = aOther.mChannels;
+		this->mFlipped = aOther.mFlipped;
 
 		aOther.mHandle = 0;
 		aOther.mpData = nullptr;
+		aOther.mCpuMemory = 0;
+		aOther.mGpuMemory = 0;
 		return *this;
 	}
 
@@ -193,6 +311,11 @@ std::string_view Texture::getPath() const noexcept {
 GLubyte* Texture::getData() const noexcept {
 	return this->mpData;
 }
+void Texture::releaseCpuCopy() noexcept {
+	stbi_image_free(this->mpData);
+	this->mpData = nullptr;
+	this->setMemory(0, this->mGpuMemory);
+}
 int32_t Texture::getWidth() const noexcept {
 	return this->mWidth;
 }
@@ -202,6 +325,16 @@ int32_t Texture::getHeight() const noexcept {
 int32_t Texture::getChannels() const noexcept {
 	return this->mChannels;
 }
+bool Texture::isFlipped() const noexcept {
+	return this->mFlipped;
+}
+
+uint64_t Texture::getCpuMemory() const noexcept {
+	return this->mCpuMemory;
+}
+uint64_t Texture::getGpuMemory() const noexcept {
+	return this->mGpuMemory;
+}
 
 uint64_t Texture::getAmountOfSlots() noexcept {
 	GLint amount;
@@ -209,7 +342,52 @@ uint64_t Texture::getAmountOfSlots() noexcept {
 	return amount;
 }
 
+uint64_t Texture::getTotalCpuMemory() noexcept {
+	return sTotalCpuMemory;
+}
+uint64_t Texture::getTotalGpuMemory() noexcept {
+	return sTotalGpuMemory;
+}
+
+//keeps the static totals in sync, every change of our counts must go through here
+void Texture::setMemory(const uint64_t aCpuMemory, const uint64_t aGpuMemory) noexcept {
+	sTotalCpuMemory += aCpuMemory - this->mCpuMemory;
+	sTotalGpuMemory += aGpuMemory - this->mGpuMemory;
+	this->mCpuMemory = aCpuMemory;
+	this->mGpuMemory = aGpuMemory;
+}
+
 Texture::~Texture() noexcept {
 	glDeleteTextures(1, &this->mHandle);
 	stbi_image_free(this->mpData);
+	this->setMemory(0, 0);
+}
+
+std::mutex TextureCache::sMutex;
+std::unordered_map<std::string, std::weak_ptr<Texture>> TextureCache::sTextures;
+
+std::shared_ptr<Texture> TextureCache::get(const std::string& aKey) noexcept {
+	std::lock_guard lock(sMutex);
+	auto it = sTextures.find(aKey);
+	if(it == sTextures.end()) return nullptr;
+	return it->second.lock();
+}
+std::shared_ptr<Texture> TextureCache::insert(const std::string& aKey, Texture&& aTexture) noexcept {
+	std::lock_guard lock(sMutex);
+
+	//drop entries whose last user is gone
+	std::erase_if(sTextures, [](const auto& aEntry) { return aEntry.second.expired(); });
+
+	auto& entry = sTextures[aKey];
+	if(std::shared_ptr<Texture> existing = entry.lock()) return existing;
+
+	aTexture.mPath = aKey;
+	std::shared_ptr<Texture> texture = std::make_shared<Texture>(std::move(aTexture));
+	entry = texture;
+	return texture;
+}
+
+uint64_t TextureCache::getAmount() noexcept {
+	std::lock_guard lock(sMutex);
+	return std::count_if(sTextures.begin(), sTextures.end(), [](const auto& aEntry) { return !aEntry.second.expired(); });
 }
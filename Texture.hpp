@@ -1,6 +1,7 @@
 #ifndef EUROTRAM_TEXTURE
 #define EUROTRAM_TEXTURE
 #include "Shader.hpp"
+#include "Image.hpp"
 
 enum class TextureBorder : uint8_t {
 	REPEAT = 0,
@@ -12,14 +13,26 @@ enum class TextureScale : uint8_t {
 	NEAREST_NEIGHBOR
 };
 
+enum class TextureResidency : uint8_t {
+	RELEASE_AFTER_UPLOAD = 0, //CPU texels freed as soon as GL has them
+	KEEP_CPU_COPY //opt in for CPU side reads (picking etc.), see getData()
+};
+
+class TextureCache;
+
 class Texture {
+	friend class TextureCache;
 public:
 	//channels = bits per pixel
-	Texture(const std::string_view aFilename, const bool aFlip = true, TextureScale aScaling = TextureScale::LINEAR, TextureBorder aBorder = TextureBorder::REPEAT) noexcept;
+	Texture(const std::string_view aFilename, const bool aFlip = true, TextureScale aScaling = TextureScale::LINEAR, TextureBorder aBorder = TextureBorder::REPEAT, TextureResidency aResidency = TextureResidency::RELEASE_AFTER_UPLOAD) noexcept;
 	Texture(const uint64_t aWidth, const uint64_t aHeight, const uint64_t aInternalFormat, const uint64_t aFormat, const uint64_t aDataType = GL_FLOAT, const bool aNoMipmaps = false, TextureScale aScaling = TextureScale::LINEAR, TextureBorder aBorder = TextureBorder::REPEAT) noexcept;
 
 	//embedded textures are a pain
-	Texture(void* aData, const size_t aPixelAmount, const bool aFlip = true, TextureScale aScaling = TextureScale::LINEAR, TextureBorder aBorder = TextureBorder::REPEAT) noexcept;
+	Texture(void* aData, const size_t aPixelAmount, const bool aFlip = true, TextureScale aScaling = TextureScale::LINEAR, TextureBorder aBorder = TextureBorder::REPEAT, TextureResidency aResidency = TextureResidency::RELEASE_AFTER_UPLOAD) noexcept;
+	//upload of data decoded elsewhere (e.g. on a worker thread)
+	Texture(TextureData&& aData, TextureScale aScaling = TextureScale::LINEAR, TextureBorder aBorder = TextureBorder::REPEAT, TextureResidency aResidency = TextureResidency::RELEASE_AFTER_UPLOAD) noexcept;
+	//precompressed KTX2 - uploads the stored mip chain as is (no flip, no glGenerateMipmap)
+	Texture(const KTX2Image& aImage, TextureScale aScaling = TextureScale::LINEAR, TextureBorder aBorder = TextureBorder::REPEAT) noexcept;
 
 	Texture(Texture&& aOther) noexcept;
 	Texture& operator=(Texture&& aOther) noexcept;
@@ -34,19 +47,50 @@ public:
 	GLuint getHandle() const noexcept;
 	std::string_view getPath() const noexcept;
 
+	//nullptr unless created with TextureResidency::KEEP_CPU_COPY
 	GLubyte* getData() const noexcept;
+	void releaseCpuCopy() noexcept;
 	int32_t getWidth() const noexcept;
 	int32_t getHeight() const noexcept;
 	int32_t getChannels() const noexcept;
+	bool isFlipped() const noexcept;
+
+	//memory accounting in bytes, GPU side is an estimate (includes mipmaps)
+	uint64_t getCpuMemory() const noexcept;
+	uint64_t getGpuMemory() const noexcept;
 
 	static uint64_t getAmountOfSlots() noexcept;
+	static uint64_t getTotalCpuMemory() noexcept;
+	static uint64_t getTotalGpuMemory() noexcept;
 
 	~Texture() noexcept;
 private:
-	std::string_view mPath; //so no duplicates
+	std::string mPath; //so no duplicates - file path or TextureCache key
 	GLuint mHandle;
 	GLubyte* mpData;
 	int32_t mWidth, mHeight, mChannels;
+	bool mFlipped;
+	uint64_t mCpuMemory, mGpuMemory;
+
+	static std::atomic<uint64_t> sTotalCpuMemory, sTotalGpuMemory;
+
+	void setMemory(const uint64_t aCpuMemory, const uint64_t aGpuMemory) noexcept;
+};
+
+//process-wide texture sharing between materials and models
+//holds weak references only - a texture lives as long as some model keeps its shared_ptr
+class TextureCache {
+public:
+	//keys come from ImageData::key (file path or getImageKey)
+	//nullptr if not loaded (or already released by everyone)
+	static std::shared_ptr<Texture> get(const std::string& aKey) noexcept;
+	//returns the already cached texture if another thread inserted it first
+	static std::shared_ptr<Texture> insert(const std::string& aKey, Texture&& aTexture) noexcept;
+
+	static uint64_t getAmount() noexcept;
+private:
+	static std::mutex sMutex;
+	static std::unordered_map<std::string, std::weak_ptr<Texture>> sTextures;
 };
 
 #endif
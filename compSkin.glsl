@@ -0,0 +1,46 @@
+#version 450 core
+
+//skins every vertex of one mesh once per frame, passes draw from the result (vertSkinned.glsl)
+
+layout(local_size_x = 64) in;
+
+layout(location = 0) uniform uint uVertexAmount;
+
+//Vertex as laid out in the VBO: position 3, texCoords 2, normal 3, materialId 1, boneIds 4, boneWeights 4
+#define VERTEX_STRIDE 17
+
+layout(std430, binding = 51) readonly buffer sJoints {
+	mat4 uJoints[];
+};
+layout(std430, binding = 52) readonly buffer sVertices {
+	float uVertices[];
+};
+
+struct SkinnedVertex {
+	vec4 position;
+	vec4 normal;
+};
+layout(std430, binding = 53) writeonly buffer sSkinned {
+	SkinnedVertex uSkinned[];
+};
+
+void main() {
+	uint id = gl_GlobalInvocationID.x;
+	if(id >= uVertexAmount) return;
+
+	uint base = id * VERTEX_STRIDE;
+	vec3 position = vec3(uVertices[base], uVertices[base+1], uVertices[base+2]);
+	vec3 normal = vec3(uVertices[base+5], uVertices[base+6], uVertices[base+7]);
+	vec4 boneIds = vec4(uVertices[base+9], uVertices[base+10], uVertices[base+11], uVertices[base+12]);
+	vec4 boneWeights = vec4(uVertices[base+13], uVertices[base+14], uVertices[base+15], uVertices[base+16]);
+
+	//same as vertAnim.glsl
+	mat4 skinMatrix =
+		boneWeights.x * uJoints[int(boneIds.x)] +
+		boneWeights.y * uJoints[int(boneIds.y)] +
+		boneWeights.z * uJoints[int(boneIds.z)] +
+		boneWeights.w * uJoints[int(boneIds.w)];
+
+	uSkinned[id].position = skinMatrix * vec4(position, 1.0);
+	uSkinned[id].normal = vec4(normalize(mat3(skinMatrix) * normal), 0.0);
+}
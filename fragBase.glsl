@@ -12,6 +12,7 @@ struct Material {
 	float textureAmount;
 	int textureSlot;
 	float textureOpacity;
+	float textureFlipped;
 	//16 byte aligned
 };
 
@@ -20,6 +21,8 @@ layout(std430, binding = 50) readonly buffer sMaterials {
 };
 
 void main() {
-	vec3 temp = mix(mat[int(pMaterialId)].color.rgb, texture(uTextures[mat[int(pMaterialId)].textureSlot], pTexCoord).rgb, mat[int(pMaterialId)].textureAmount);
+	//UVs are flipped on load to match stbi flipped images, undo it for unflipped ones
+	vec2 texCoord = vec2(pTexCoord.x, mix(1.0 - pTexCoord.y, pTexCoord.y, mat[int(pMaterialId)].textureFlipped));
+	vec3 temp = mix(mat[int(pMaterialId)].color.rgb, texture(uTextures[mat[int(pMaterialId)].textureSlot], texCoord).rgb, mat[int(pMaterialId)].textureAmount);
 	oColor = vec4(temp, 0.2);
 }
@@ -8,6 +8,7 @@ layout(location = 4) in vec4 BoneIds;
 layout(location = 5) in vec4 BoneWeights;
 
 layout(location = 15) uniform mat4 uMatrix;
+layout(location = 14) uniform uint uJointOffset; //baked palettes: first matrix of the (clip, frame), 0 otherwise
 
 out vec2 pTexCoord;
 flat out float pMaterialId;
@@ -21,10 +22,10 @@ void main() {
 	//unused bones will have weight 0
 
 	mat4 skinMatrix =
-		BoneWeights.x * uJoints[int(BoneIds.x)] +
-		BoneWeights.y * uJoints[int(BoneIds.y)] +
-		BoneWeights.z * uJoints[int(BoneIds.z)] +
-		BoneWeights.w * uJoints[int(BoneIds.w)];
+		BoneWeights.x * uJoints[uJointOffset + uint(BoneIds.x)] +
+		BoneWeights.y * uJoints[uJointOffset + uint(BoneIds.y)] +
+		BoneWeights.z * uJoints[uJointOffset + uint(BoneIds.z)] +
+		BoneWeights.w * uJoints[uJointOffset + uint(BoneIds.w)];
 
 	gl_Position = uMatrix * skinMatrix * vec4(Position, 1.0);
 	pTexCoord = TexCoord;
@@ -0,0 +1,39 @@
+#version 450 core
+
+layout(location = 0) in vec3 Position;
+layout(location = 1) in vec2 TexCoord;
+layout(location = 2) in vec3 Normal;
+layout(location = 3) in float MaterialId;
+layout(location = 4) in vec4 BoneIds;
+layout(location = 5) in vec4 BoneWeights;
+
+layout(location = 15) uniform mat4 uMatrix;
+
+out vec2 pTexCoord;
+flat out float pMaterialId;
+
+//3x4 palette (AffineMatrix in ModelData.hpp), the (0,0,0,1) row is implied
+struct AffineMatrix {
+	vec4 rows[3];
+};
+layout(std430, binding = 51) readonly buffer sJoints {
+	AffineMatrix uJoints[];
+};
+
+void main() {
+	//same blend as vertAnim.glsl, 3 rows instead of 4 columns
+	//unused bones will have weight 0
+	vec4 rows[3];
+	for(int r = 0; r < 3; r++) {
+		rows[r] =
+			BoneWeights.x * uJoints[int(BoneIds.x)].rows[r] +
+			BoneWeights.y * uJoints[int(BoneIds.y)].rows[r] +
+			BoneWeights.z * uJoints[int(BoneIds.z)].rows[r] +
+			BoneWeights.w * uJoints[int(BoneIds.w)].rows[r];
+	}
+
+	vec4 position = vec4(Position, 1.0);
+	gl_Position = uMatrix * vec4(dot(rows[0], position), dot(rows[1], position), dot(rows[2], position), 1.0);
+	pTexCoord = TexCoord;
+	pMaterialId = MaterialId;
+}
@@ -0,0 +1,54 @@
+#version 450 core
+
+layout(location = 0) in vec3 Position;
+layout(location = 1) in vec2 TexCoord;
+layout(location = 2) in vec3 Normal;
+layout(location = 3) in float MaterialId;
+layout(location = 4) in vec4 BoneIds;
+layout(location = 5) in vec4 BoneWeights;
+
+layout(location = 15) uniform mat4 uMatrix;
+
+out vec2 pTexCoord;
+flat out float pMaterialId;
+
+//dual quaternion palette (DualQuaternion in Skinning.hpp), rigid joints only
+struct DualQuaternion {
+	vec4 real;
+	vec4 dual;
+};
+layout(std430, binding = 51) readonly buffer sJoints {
+	DualQuaternion uJoints[];
+};
+
+void main() {
+	//linear blend, all joints flipped into the same hemisphere as the first one
+	DualQuaternion first = uJoints[int(BoneIds.x)];
+	vec4 real = BoneWeights.x * first.real;
+	vec4 dual = BoneWeights.x * first.dual;
+	for(int i = 1; i < 4; i++) {
+		DualQuaternion joint = uJoints[int(BoneIds[i])];
+		float weight = dot(first.real, joint.real) < 0.0 ? -BoneWeights[i] : BoneWeights[i];
+		real += weight * joint.real;
+		dual += weight * joint.dual;
+	}
+
+	//unused bones have weight 0 - collapse like the matrix path does
+	float len = length(real);
+	if(len == 0.0) {
+		gl_Position = uMatrix * vec4(0.0, 0.0, 0.0, 1.0);
+		pTexCoord = TexCoord;
+		pMaterialId = MaterialId;
+		return;
+	}
+	real /= len;
+	dual /= len;
+
+	//rotate, then translation = 2 * dual * conjugate(real)
+	vec3 position = Position + 2.0 * cross(real.xyz, cross(real.xyz, Position) + real.w * Position);
+	position += 2.0 * (real.w * dual.xyz - dual.w * real.xyz + cross(real.xyz, dual.xyz));
+
+	gl_Position = uMatrix * vec4(position, 1.0);
+	pTexCoord = TexCoord;
+	pMaterialId = MaterialId;
+}
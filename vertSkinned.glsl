@@ -0,0 +1,29 @@
+#version 450 core
+
+//passthrough for meshes skinned by compSkin.glsl - gl_VertexID is the index into the skinned buffer
+
+layout(location = 0) in vec3 Position;
+layout(location = 1) in vec2 TexCoord;
+layout(location = 2) in vec3 Normal;
+layout(location = 3) in float MaterialId;
+layout(location = 4) in vec4 BoneIds;
+layout(location = 5) in vec4 BoneWeights;
+
+layout(location = 15) uniform mat4 uMatrix;
+
+out vec2 pTexCoord;
+flat out float pMaterialId;
+
+struct SkinnedVertex {
+	vec4 position;
+	vec4 normal;
+};
+layout(std430, binding = 53) readonly buffer sSkinned {
+	SkinnedVertex uSkinned[];
+};
+
+void main() {
+	gl_Position = uMatrix * uSkinned[gl_VertexID].position;
+	pTexCoord = TexCoord;
+	pMaterialId = MaterialId;
+}